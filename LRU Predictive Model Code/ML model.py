@@ -11,9 +11,11 @@ import seaborn as sns
 import matplotlib.pyplot as plt
 from math import pi
 
-# Load dataset
+from access_columns import read_access_data
+
+# Load dataset (the CSV, or a column file from tools/lrustat2col)
 file_path = '/Users/muntasirmamun/Downloads/TEST.csv'
-data = pd.read_csv(file_path)
+data = read_access_data(file_path)
 
 # Encode 'Access Type' as numeric values
 data['Access Type'] = LabelEncoder().fit_transform(data['Access Type'])
@@ -0,0 +1,67 @@
+"""Load LLC access data from lruStat column files without parsing.
+
+A column file (written by tools/lrustat2col from an lruStat trace or one of
+the CSVs here) holds each field as a fixed-width array; the layout is
+documented in replacement/lruStat/access_columns.h. load_columns() maps every
+column with np.memmap, so a multi-GB trace opens instantly and only the pages
+that are used are ever read.
+
+read_access_data() gives the same DataFrame the scripts used to get from
+pd.read_csv, from either a column file or a CSV.
+"""
+
+import numpy as np
+import pandas as pd
+
+COLUMN_MAGIC = b"LRUSTCOL"
+COLUMN_VERSION = 1
+
+HEADER_DTYPE = np.dtype([("magic", "S8"), ("version", "<u4"), ("num_columns", "<u4"), ("count", "<u8")])
+ENTRY_DTYPE = np.dtype([("name", "S8"), ("dtype", "S8"), ("offset", "<u8")])
+
+ACCESS_TYPE_WRITE = 3
+BLOCK_SIZE = 64  # the Data Size of every access, as lruStat and lrustat2csv write it
+
+
+def load_columns(path):
+    """Map every column of a column file; returns {name: read-only np.memmap}."""
+    header = np.fromfile(path, dtype=HEADER_DTYPE, count=1)
+    if len(header) != 1 or header["magic"][0] != COLUMN_MAGIC or header["version"][0] != COLUMN_VERSION:
+        raise ValueError(f"{path} is not an lruStat column file of version {COLUMN_VERSION}")
+
+    count = int(header["count"][0])
+    entries = np.fromfile(path, dtype=ENTRY_DTYPE, count=int(header["num_columns"][0]), offset=HEADER_DTYPE.itemsize)
+    return {
+        entry["name"].decode(): np.memmap(path, dtype=np.dtype(entry["dtype"].decode()), mode="r", offset=int(entry["offset"]), shape=(count,))
+        for entry in entries
+    }
+
+
+def is_column_file(path):
+    with open(path, "rb") as f:
+        return f.read(len(COLUMN_MAGIC)) == COLUMN_MAGIC
+
+
+def read_access_data(path, with_ip=False):
+    """Access data under the old CSV column names, from a column file or a CSV.
+
+    Access Type is READ or WRITE as in the CSVs lruStat wrote, as a
+    categorical, and Data Size is the block size, which a column file does not
+    store. with_ip adds the IP and CPU columns of a column file.
+    """
+    if not is_column_file(path):
+        return pd.read_csv(path)
+
+    columns = load_columns(path)
+    data = {
+        "Memory Address": columns["address"],
+        "Cache Set": columns["set"],
+        "Access Type": pd.Categorical.from_codes((columns["type"] == ACCESS_TYPE_WRITE).astype(np.int8), ["READ", "WRITE"]),
+        "Cycle Count": columns["cycle"],
+        "Data Size": np.full(len(columns["cycle"]), BLOCK_SIZE, dtype=np.uint8),
+        "Hit/Miss": columns["hit"],
+    }
+    if with_ip:
+        data["IP"] = columns["ip"]
+        data["CPU"] = columns["cpu"]
+    return pd.DataFrame(data, copy=False)
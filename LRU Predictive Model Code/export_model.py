@@ -0,0 +1,166 @@
+"""Export a trained hit/miss model for the mlPredict replacement policy.
+
+    python export_model.py keras <model.h5> <train.csv> <out.model>
+    python export_model.py logistic [--ip] <train.csv> <out.model>
+    python export_model.py svm [--ip] <train.csv> <out.model>
+
+keras exports a Sequential model of an optional LSTM and Dense layers, such as
+LSTM/lstm_model.h5, reading the weights straight from the .h5 file (TensorFlow
+is not needed). The notebook did not save its MinMaxScaler, so it is fitted
+again on the training data, which must have the columns the model was trained
+on. The model predicts every column of the next access; the policy uses its
+Hit/Miss output.
+
+logistic and svm train the linear models of "ML model.py" and the SVM
+notebooks (standardized features, every column but Hit/Miss) and export them
+as one dense layer. The SVM is a linear one; kernel SVMs have no compact
+weights to export. --ip adds the IP of each access as a feature, which needs
+training data with an IP column (lrustat2csv --all, or a column file); the
+policy then caches the model's predictions per PC.
+
+Training data is a CSV or a column file from tools/lrustat2col. The output is
+the text format read by replacement/mlPredict/inference.h.
+"""
+
+import json
+import sys
+
+import h5py
+import numpy as np
+
+from access_columns import BLOCK_SIZE, read_access_data
+
+# CSV column -> feature name in the policy
+FEATURES = {
+    "Memory Address": "address",
+    "Cache Set": "set",
+    "Access Type": "type",
+    "Cycle Count": "cycle",
+    "Data Size": "size",
+    "Hit/Miss": "hit",
+    "IP": "ip",
+}
+
+
+def load_features(path, columns):
+    """The given columns of the training data as float64, Access Type as 0/1."""
+    data = read_access_data(path, with_ip="IP" in columns)
+    if "Data Size" in columns and "Data Size" not in data:
+        data["Data Size"] = BLOCK_SIZE
+    data["Access Type"] = (data["Access Type"].astype(str) == "WRITE").astype(np.int8)
+    return data[columns].to_numpy(dtype=np.float64)
+
+
+def write_values(out, values):
+    values = np.asarray(values, dtype=np.float64).ravel()
+    for start in range(0, len(values), 8):
+        out.write(" ".join(repr(float(v)) for v in values[start : start + 8]) + "\n")
+
+
+def write_model(path, columns, history, output, threshold, offsets, factors, layers):
+    """layers: ("lstm", activation, kernel, recurrent, bias) or ("dense", activation, kernel, bias)"""
+    with open(path, "w") as out:
+        out.write("mlpredict 1\n")
+        out.write(f"features {len(columns)} " + " ".join(FEATURES[c] for c in columns) + "\n")
+        out.write(f"history {history}\noutput {output}\nthreshold {threshold!r}\n")
+        out.write(f"scale {len(columns)}\n")
+        write_values(out, offsets)
+        write_values(out, factors)
+        for layer in layers:
+            if layer[0] == "lstm":
+                _, activation, kernel, recurrent, bias = layer
+                out.write(f"lstm {kernel.shape[0]} {recurrent.shape[0]} {activation}\n")
+                for values in (kernel, recurrent, bias):
+                    write_values(out, values)
+            else:
+                _, activation, kernel, bias = layer
+                out.write(f"dense {kernel.shape[0]} {kernel.shape[1]} {activation}\n")
+                write_values(out, kernel)
+                write_values(out, bias)
+        out.write("end\n")
+
+
+def layer_weights(weights, name):
+    """{'kernel': ..., 'recurrent_kernel': ..., 'bias': ...} of one saved layer."""
+    found = {}
+
+    def visit(path, item):
+        if isinstance(item, h5py.Dataset):
+            found[path.rsplit("/", 1)[-1].split(":")[0]] = item[()]
+
+    weights[name].visititems(visit)
+    return found
+
+
+def export_keras(model_path, train_path, out_path):
+    with h5py.File(model_path, "r") as f:
+        config = json.loads(f.attrs["model_config"])
+        weights = f["model_weights"] if "model_weights" in f else f
+
+        layers = []
+        history = 1
+        for layer in config["config"]["layers"]:
+            kind, settings = layer["class_name"], layer["config"]
+            if kind == "InputLayer":
+                continue
+            w = layer_weights(weights, settings["name"])
+            if kind == "LSTM":
+                if settings.get("return_sequences") or settings.get("recurrent_activation") != "sigmoid" or layers:
+                    raise ValueError("only a first LSTM layer returning its last state, with sigmoid gates, is supported")
+                history = settings["batch_input_shape"][1]
+                layers.append(("lstm", settings["activation"], w["kernel"], w["recurrent_kernel"], w["bias"]))
+            elif kind == "Dense":
+                layers.append(("dense", settings["activation"], w["kernel"], w["bias"]))
+            else:
+                raise ValueError(f"unsupported layer {kind}")
+
+    # The notebook scaled every numeric column of its training data in order
+    columns = [c for c in FEATURES if c != "IP"]
+    inputs = layers[0][2].shape[0]
+    if inputs != len(columns):
+        raise ValueError(f"the model takes {inputs} features per access; expected {len(columns)} ({', '.join(columns)})")
+
+    data = load_features(train_path, columns)
+    low, high = data.min(axis=0), data.max(axis=0)
+    span = np.where(high > low, high - low, 1.0)
+    write_model(out_path, columns, history, columns.index("Hit/Miss"), 0.5, low, 1.0 / span, layers)
+
+
+def export_linear(kind, train_path, out_path, with_ip=False):
+    from sklearn.linear_model import LogisticRegression
+    from sklearn.preprocessing import StandardScaler
+    from sklearn.svm import LinearSVC
+
+    columns = ["Memory Address", "Cache Set", "Access Type", "Cycle Count"] + (["IP"] if with_ip else [])
+    data = load_features(train_path, columns + ["Hit/Miss"])
+    x, y = data[:, :-1], data[:, -1].astype(int)
+
+    scaler = StandardScaler().fit(x)
+    # class_weight stands in for the notebooks' SMOTE, which needs imblearn
+    if kind == "logistic":
+        model = LogisticRegression(class_weight="balanced").fit(scaler.transform(x), y)
+        activation, threshold = "sigmoid", 0.5
+    else:
+        model = LinearSVC(class_weight="balanced").fit(scaler.transform(x), y)
+        activation, threshold = "linear", 0.0
+    print(f"training accuracy {model.score(scaler.transform(x), y):.4f}")
+
+    layers = [("dense", activation, model.coef_.T, model.intercept_)]
+    write_model(out_path, columns, 1, 0, threshold, scaler.mean_, 1.0 / scaler.scale_, layers)
+
+
+def main(argv):
+    if len(argv) == 5 and argv[1] == "keras":
+        export_keras(argv[2], argv[3], argv[4])
+    elif len(argv) == 4 and argv[1] in ("logistic", "svm"):
+        export_linear(argv[1], argv[2], argv[3])
+    elif len(argv) == 5 and argv[1] in ("logistic", "svm") and argv[2] == "--ip":
+        export_linear(argv[1], argv[3], argv[4], with_ip=True)
+    else:
+        print(__doc__.strip().split("\n\n")[1], file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
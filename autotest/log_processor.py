@@ -1,10 +1,17 @@
 import os
 import re
 import csv
+import sys
+
+# Reference implementation of summary.csv. For large sweeps use
+# tools/sweep_summary, which reads the --json stats in parallel and also
+# writes the speedup and MPKI tables.
+if len(sys.argv) not in (2, 3):
+    sys.exit(f"Usage: {sys.argv[0]} <log_folder> [output_csv]")
 
 # Folder containing the log files
-log_folder = "C:\\Users\\Charles\\Desktop\\Data Processing\\ship_mod 4-20241205201926"  # Change this to your folder path
-output_csv = "summary.csv"
+log_folder = sys.argv[1]
+output_csv = sys.argv[2] if len(sys.argv) > 2 else "summary.csv"
 
 # CSV column headers
 headers = [
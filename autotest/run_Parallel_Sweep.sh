@@ -0,0 +1,152 @@
+#!/bin/bash
+
+# Run every (replacement policy, trace) pair across several workers.
+#
+# One ChampSim binary is built per policy up front (bin/champsim_<policy>, each
+# from its own copy of champsim_config.json), so champsim_config.json itself is
+# never modified and the runs do not depend on each other. With -r a single
+# binary is built instead, with the runtime module as the LLC replacement, and
+# each job picks its policy through CHAMPSIM_REPLACEMENT_LLC. Jobs are then
+# pulled from a queue by N workers.
+#
+# Logs go to <output_dir>/<trace>.<policy>.log, named like the other autotest
+# scripts so log_processor.py reads them unchanged, with the simulator's JSON
+# stats next to each log as <trace>.<policy>.json. A log is only moved into
+# place when its run succeeds, so running the same sweep again skips finished
+# jobs and retries failed or interrupted ones. Every job's wall time is
+# appended to <output_dir>/job_times.tsv. When tools/sweep_summary has been
+# built in bin/, the sweep ends by writing summary.csv, speedup.csv and
+# mpki.csv into <output_dir>.
+
+usage() {
+  echo "Usage: $0 [-j jobs] [-o output_dir] [-p \"policy ...\"] [-r] [-n] <warmup_instructions> <simulation_instructions> <trace_folder_filepath>"
+  echo "  -j  number of parallel jobs (default: number of cores)"
+  echo "  -o  log directory; reuse it to resume a sweep (default: logs/sweep-<timestamp>)"
+  echo "  -p  policies to run (default: every folder in replacement/, or every policy in the runtime module with -r; belady and mlPredict only on request)"
+  echo "  -r  build one binary with every policy and select the policy at run time"
+  echo "  -n  skip the build and use the binaries already in bin/"
+  exit 1
+}
+
+jobs=$(nproc)
+logs_dir=""
+policies=""
+build=1
+runtime=0
+while getopts "j:o:p:rn" opt; do
+  case "$opt" in
+    j) jobs="$OPTARG" ;;
+    o) logs_dir="$OPTARG" ;;
+    p) policies="$OPTARG" ;;
+    r) runtime=1 ;;
+    n) build=0 ;;
+    *) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+if [ "$#" -ne 3 ]; then
+  usage
+fi
+
+if ! command -v jq &> /dev/null; then
+  echo "jq is required to write the per-policy configs (sudo apt-get install -y jq)"
+  exit 1
+fi
+
+warmup_instructions="$1"
+simulation_instructions="$2"
+trace_folder_filepath="$3"
+
+test_dir=$(pwd)
+champsim_dir=$(dirname "$test_dir")
+config_file="$champsim_dir/champsim_config.json"
+
+# belady needs a capture of each trace's own LLC stream and mlPredict an
+# exported model, so they are left out of the default list
+if [ -z "$policies" ] && [ "$runtime" -eq 1 ]; then
+  policies=" $(grep -o '{"[A-Za-z0-9_]*"' "$champsim_dir/replacement/runtime/policies.h" | tr -d '{"' | grep -vx -e belady -e mlPredict | tr '\n' ' ')"
+elif [ -z "$policies" ]; then
+  for replacement_folder in "$champsim_dir"/replacement/*/; do
+    case "$(basename "$replacement_folder")" in
+      runtime | belady | mlPredict) ;;
+      *) policies="$policies $(basename "$replacement_folder")" ;;
+    esac
+  done
+fi
+if [ -z "$logs_dir" ]; then
+  logs_dir="${test_dir}/logs/sweep-$(date +"%Y%m%d%H%M%S")"
+fi
+mkdir -p "$logs_dir"
+logs_dir=$(cd "$logs_dir" && pwd)
+
+echo "Champsim directory: $champsim_dir"
+echo "Policies:$policies"
+echo "Log directory: $logs_dir"
+echo "Workers: $jobs"
+
+# Build one binary per policy, or the single runtime binary
+if [ "$build" -eq 1 ]; then
+  configs_dir="$logs_dir/configs"
+  mkdir -p "$configs_dir"
+  config_list=()
+  binaries="$policies"
+  if [ "$runtime" -eq 1 ]; then
+    binaries="runtime"
+  fi
+  for binary in $binaries; do
+    jq --arg replacement "$binary" --arg name "champsim_${binary}" \
+      '.LLC.replacement = $replacement | .executable_name = $name' "$config_file" > "$configs_dir/${binary}.json" || exit 1
+    config_list+=("$configs_dir/${binary}.json")
+  done
+
+  cd "$champsim_dir" || exit 1
+  ./config.sh "${config_list[@]}" && make -j "$jobs" || { echo "Build failed"; exit 1; }
+  cd "$test_dir" || exit 1
+fi
+
+# Run one job; called by the workers with the policy and the trace file
+run_job() {
+  policy="$1"
+  trace_file="$2"
+  trace_name=$(basename "$trace_file" .xz)
+  log_file="$logs_dir/${trace_name}.${policy}.log"
+  json_file="$logs_dir/${trace_name}.${policy}.json"
+
+  if [ -f "$log_file" ]; then
+    echo "Skipping ${trace_name} with ${policy}: already finished"
+    return 0
+  fi
+
+  binary="${champsim_dir}/bin/champsim_${policy}"
+  if [ "$runtime" -eq 1 ]; then
+    binary="${champsim_dir}/bin/champsim_runtime"
+  fi
+
+  start=$(date +%s.%N)
+  CHAMPSIM_REPLACEMENT_LLC="$policy" "$binary" --hide-heartbeat --json "${json_file}.part" -w "$warmup_instructions" -i "$simulation_instructions" "$trace_file" > "${log_file}.part" 2>&1
+  status=$?
+  elapsed=$(awk -v s="$start" -v e="$(date +%s.%N)" 'BEGIN { print e - s }')
+
+  if [ "$status" -eq 0 ]; then
+    mv "${json_file}.part" "$json_file" 2> /dev/null
+    mv "${log_file}.part" "$log_file"
+  fi
+  printf "%s\t%s\t%.1f\t%s\n" "$policy" "$trace_name" "$elapsed" "$status" >> "$logs_dir/job_times.tsv"
+  printf "Finished %s with %s in %.1f s (exit %s)\n" "$trace_name" "$policy" "$elapsed" "$status"
+}
+export -f run_job
+export champsim_dir logs_dir warmup_instructions simulation_instructions runtime
+
+sweep_start=$(date +%s)
+for policy in $policies; do
+  for trace_file in "$trace_folder_filepath"/*.xz; do
+    printf "%s\0%s\0" "$policy" "$trace_file"
+  done
+done | xargs -0 -n 2 -P "$jobs" bash -c 'run_job "$0" "$1"'
+
+echo "Sweep finished in $(( $(date +%s) - sweep_start )) s; per-job times in $logs_dir/job_times.tsv"
+
+if [ -x "$champsim_dir/bin/sweep_summary" ]; then
+  "$champsim_dir/bin/sweep_summary" -j "$jobs" "$logs_dir"
+fi
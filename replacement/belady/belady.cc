@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "../policy.h"
+#include "../lruStat/access_stream.h"
+
+// Belady's OPT: evict the line whose next use is furthest in the future.
+//
+// The future comes from a capture of the same cache's access stream, made
+// with lruStat (unfiltered) on an earlier run of the same workload, or the
+// trace being replayed by tools/llc_replay. BELADY_TRACE (or
+// BELADY_TRACE_<cache name>) lists the capture files, comma-separated; per-CPU
+// traces are merged by cycle. The policy counts the accesses it sees, and
+// the n-th one is taken to be the n-th access of the capture.
+//
+// The capture is indexed once, before the run: the positions of every access
+// are grouped by block address (a CSR layout, one slice per block) with a
+// cursor per block. Indexing reads the capture twice, to count each block's
+// accesses and then to fill its slice, so the only per-access state is the
+// position itself: 4 bytes, or 8 for a capture of 2^32 accesses or more. Each access then finds its block's next use by moving
+// that cursor forward, so the whole run costs O(accesses) on top of the cache.
+// Looking the next use up by block rather than by position also keeps the
+// oracle sensible when the run drifts from the capture, e.g. through
+// different timing; the drift is reported with the final stats.
+
+namespace
+{
+constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+class next_use_index
+{
+public:
+  void build(const std::vector<std::string>& paths)
+  {
+    // First pass: intern each block and count its accesses in offsets[id + 1]
+    offsets.assign(1, 0);
+    for_each_block(paths, [this](uint64_t block) {
+      uint32_t id = intern(block);
+      if (id + 1 == offsets.size())
+        offsets.push_back(0);
+      ++offsets[id + 1];
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    // Second pass: fill the slice of each block with its positions, in stream order
+    wide = accesses() > std::numeric_limits<uint32_t>::max();
+    if (wide)
+      positions64.resize(accesses());
+    else
+      positions32.resize(accesses());
+    cursors.assign(offsets.begin(), std::prev(offsets.end()));
+    uint64_t pos = 0;
+    for_each_block(paths, [this, &pos](uint64_t block) {
+      uint64_t& cursor = cursors[find(block)];
+      if (wide)
+        positions64[cursor++] = pos;
+      else
+        positions32[cursor++] = static_cast<uint32_t>(pos);
+      ++pos;
+    });
+    if (pos != accesses())
+      throw std::runtime_error("the capture changed while it was being indexed");
+    cursors.assign(offsets.begin(), std::prev(offsets.end()));
+  }
+
+  uint64_t accesses() const { return offsets.empty() ? 0 : offsets.back(); }
+  uint64_t blocks() const { return cursors.size(); }
+
+  // Position of the first access to block after now, or NEVER. Moves the
+  // block's cursor past now; matched tells whether now itself was an access
+  // to block.
+  uint64_t advance(uint64_t block, uint64_t now, bool& matched)
+  {
+    matched = false;
+    uint32_t id = find(block);
+    if (id == NO_ID)
+      return NEVER;
+
+    if (wide)
+      return scan(positions64, cursors[id], offsets[id + 1], now, matched);
+    return scan(positions32, cursors[id], offsets[id + 1], now, matched);
+  }
+
+private:
+  static constexpr uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
+
+  // Open-addressing table from block address to id; keys hold block + 1 so 0 marks a free slot
+  std::vector<uint64_t> keys = std::vector<uint64_t>(1024);
+  std::vector<uint32_t> ids = std::vector<uint32_t>(1024);
+  uint32_t num_ids = 0;
+
+  std::vector<uint64_t> offsets; // first position of each block's slice, plus the end
+  std::vector<uint64_t> cursors; // next unconsumed position of each block
+
+  // Stream positions, grouped by block; positions64 only if they do not fit in 32 bits
+  bool wide = false;
+  std::vector<uint32_t> positions32;
+  std::vector<uint64_t> positions64;
+
+  template <typename Position>
+  static uint64_t scan(const std::vector<Position>& positions, uint64_t& cursor, uint64_t end, uint64_t now, bool& matched)
+  {
+    while (cursor < end && positions[cursor] <= now)
+      matched = positions[cursor++] == now;
+    return cursor < end ? positions[cursor] : NEVER;
+  }
+
+  // Call visit with the block address of every access of the capture, in order
+  template <typename Visit>
+  static void for_each_block(const std::vector<std::string>& paths, Visit&& visit)
+  {
+    lrustat::merged_stream stream{paths};
+    std::vector<lrustat::access_record> records;
+    while (stream.next(records))
+      for (const auto& r : records)
+        visit(r.address >> LOG2_BLOCK_SIZE);
+  }
+
+  std::size_t slot(uint64_t key) const { return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> 20) & (keys.size() - 1); }
+
+  uint32_t find(uint64_t block) const
+  {
+    for (std::size_t i = slot(block + 1);; i = (i + 1) & (keys.size() - 1)) {
+      if (keys[i] == block + 1)
+        return ids[i];
+      if (keys[i] == 0)
+        return NO_ID;
+    }
+  }
+
+  uint32_t intern(uint64_t block)
+  {
+    if (2 * (num_ids + 1) > keys.size())
+      grow();
+    std::size_t i = slot(block + 1);
+    for (; keys[i] != 0; i = (i + 1) & (keys.size() - 1))
+      if (keys[i] == block + 1)
+        return ids[i];
+    if (num_ids == NO_ID)
+      throw std::length_error("too many distinct blocks in the capture");
+    keys[i] = block + 1;
+    ids[i] = num_ids;
+    return num_ids++;
+  }
+
+  void grow()
+  {
+    auto old_keys = std::exchange(keys, std::vector<uint64_t>(2 * keys.size()));
+    auto old_ids = std::exchange(ids, std::vector<uint32_t>(2 * ids.size()));
+    for (std::size_t j = 0; j < old_keys.size(); ++j) {
+      if (old_keys[j] != 0) {
+        std::size_t i = slot(old_keys[j]);
+        while (keys[i] != 0)
+          i = (i + 1) & (keys.size() - 1);
+        keys[i] = old_keys[j];
+        ids[i] = old_ids[j];
+      }
+    }
+  }
+};
+
+class belady : public replacement::policy
+{
+  next_use_index index;
+  std::vector<uint64_t> next_use; // per line
+  uint64_t now = 0;
+  uint64_t drifted = 0;
+
+public:
+  using policy::policy;
+
+  void initialize_replacement() override;
+  uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) override;
+  void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                uint8_t hit) override;
+  void replacement_final_stats() override;
+};
+} // namespace
+
+void belady::initialize_replacement()
+{
+  const char* list = setting("BELADY_TRACE");
+  if (list == nullptr)
+    throw std::invalid_argument(NAME + " belady needs a capture of its access stream; set BELADY_TRACE or BELADY_TRACE_" + NAME);
+
+  std::vector<std::string> paths;
+  std::istringstream files{list};
+  for (std::string path; std::getline(files, path, ',');)
+    if (!path.empty())
+      paths.push_back(path);
+
+  index.build(paths);
+  next_use.assign(NUM_SET * NUM_WAY, NEVER);
+  std::cout << NAME << " belady: " << index.accesses() << " accesses to " << index.blocks() << " blocks from " << list << std::endl;
+}
+
+uint32_t belady::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
+{
+  auto invalid = std::find_if_not(current_set, std::next(current_set, NUM_WAY), [](const BLOCK& block) { return block.valid; });
+  if (invalid != std::next(current_set, NUM_WAY))
+    return static_cast<uint32_t>(std::distance(current_set, invalid));
+
+  // The line reused furthest in the future
+  auto begin = std::next(std::begin(next_use), set * NUM_WAY);
+  auto end = std::next(begin, NUM_WAY);
+  return static_cast<uint32_t>(std::distance(begin, std::max_element(begin, end)));
+}
+
+void belady::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                      uint8_t hit)
+{
+  bool matched;
+  uint64_t next = index.advance(full_addr >> LOG2_BLOCK_SIZE, now++, matched);
+  if (!matched)
+    ++drifted;
+  if (way < NUM_WAY)
+    next_use.at(set * NUM_WAY + way) = next;
+}
+
+void belady::replacement_final_stats()
+{
+  std::cout << NAME << " belady: " << now << " accesses, " << drifted << " not at their position in the capture";
+  if (now != index.accesses() || drifted > 0)
+    std::cout << " (the run differs from the capture of " << index.accesses() << " accesses, so this is not exactly OPT)";
+  std::cout << std::endl;
+}
+
+REPLACEMENT_LEGACY_HOOKS(belady, )
@@ -0,0 +1,133 @@
+#ifndef REPLACEMENT_CHECKPOINT_H
+#define REPLACEMENT_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace replacement::checkpoint
+{
+constexpr char MAGIC[8] = {'R', 'E', 'P', 'L', 'C', 'K', 'P', 'T'};
+constexpr uint32_t VERSION = 3;
+
+class archive;
+
+template <typename T, typename = void>
+struct has_serialize_state : std::false_type {
+};
+template <typename T>
+struct has_serialize_state<T, std::void_t<decltype(std::declval<T&>().serialize_state(std::declval<archive&>()))>> : std::true_type {
+};
+
+// The state of a replacement policy, written to or read from a binary stream.
+//
+// A policy lists its state once, in serialize_state(), and the same list
+// saves it and loads it back: ar(rrpv, table, sampler) writes the three
+// fields when saving and overwrites them when loading. A field is any
+// trivially copyable value (copied as bytes), a std::vector of fields
+// (length, then elements), or a struct with serialize_state(archive&) of its
+// own. The layout is the host's; a checkpoint is meant to be read back by
+// the same build on the same machine.
+class archive
+{
+public:
+  explicit archive(std::ostream& out) : out(&out) {}
+  explicit archive(std::istream& in) : in(&in) {}
+
+  bool loading() const { return in != nullptr; }
+
+  template <typename... T>
+  archive& operator()(T&... fields)
+  {
+    (field(fields), ...);
+    return *this;
+  }
+
+  // n elements at data, for arrays that do not know their own size
+  template <typename T>
+  void array(T* data, std::size_t n)
+  {
+    if constexpr (std::is_trivially_copyable_v<T> && !has_serialize_state<T>::value) {
+      bytes(data, n * sizeof(T));
+    } else {
+      for (std::size_t i = 0; i < n; ++i)
+        field(data[i]);
+    }
+  }
+
+  // A value that must be the same when loading, e.g. a table size
+  template <typename T>
+  void expect(T value, const char* what)
+  {
+    T stored = value;
+    field(stored);
+    if (stored != value)
+      throw std::runtime_error(std::string{"checkpoint has a different "} + what);
+  }
+
+private:
+  std::ostream* out = nullptr;
+  std::istream* in = nullptr;
+
+  void bytes(void* data, std::size_t n)
+  {
+    if (in) {
+      if (!in->read(static_cast<char*>(data), static_cast<std::streamsize>(n)))
+        throw std::runtime_error("checkpoint is truncated");
+    } else {
+      out->write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+    }
+  }
+
+  template <typename T>
+  void field(T& value)
+  {
+    if constexpr (has_serialize_state<T>::value) {
+      value.serialize_state(*this);
+    } else {
+      static_assert(std::is_trivially_copyable_v<T>, "give this type a serialize_state(archive&)");
+      bytes(&value, sizeof(T));
+    }
+  }
+
+  template <typename T, typename Allocator>
+  void field(std::vector<T, Allocator>& values)
+  {
+    uint64_t n = values.size();
+    field(n);
+    if (in)
+      values.resize(n);
+    array(values.data(), values.size());
+  }
+
+  void field(std::vector<bool>& values)
+  {
+    uint64_t n = values.size();
+    field(n);
+    if (in)
+      values.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      bool value = values[i];
+      field(value);
+      values[i] = value;
+    }
+  }
+
+  void field(std::string& value)
+  {
+    uint64_t n = value.size();
+    field(n);
+    if (in)
+      value.resize(n);
+    bytes(value.data(), n);
+  }
+};
+} // namespace replacement::checkpoint
+
+#endif
@@ -1,6 +1,5 @@
 #include <algorithm>
 #include <cassert>
-#include <map>
 #include <vector>
 #include <iostream>
 #include <cmath>
@@ -9,69 +8,84 @@
 #include "hawkeye_predictor.h"
 #include "optgen.h"
 #include "helper_function.h"
-
-#define NUM_CORE 1
-#define NUM_SET (NUM_CORE * 1024)
-#define NUM_WAY 16
+#include "history_sampler.h"
+#include "../policy.h"
 
 // 3-bit RRIP counter
 #define MAXRRIP 7
-uint32_t rrip[NUM_SET][NUM_WAY];
-
-// Hawkeye predictors for demand and prefetch requests
-Hawkeye_Predictor* predictor_demand;
-Hawkeye_Predictor* predictor_prefetch;
-
-OPTgen optgen_occup_vector[NUM_SET];
-
-// Prefetching metadata
-bool prefetching[NUM_SET][NUM_WAY];
 
 // Sampler components for tracking cache history
 #define SAMPLER_ENTRIES 2800
-#define SAMPLER_HIST 8
 #define SAMPLER_SETS (SAMPLER_ENTRIES / SAMPLER_HIST)
-std::vector<std::map<uint64_t, HISTORY>> cache_history_sampler;
-uint64_t sample_signature[NUM_SET][NUM_WAY];
 
 // History timer
 #define TIMER_SIZE 1024
-uint64_t set_timer[NUM_SET];
 
 // Helper macros for sampling
 #define bitmask(l) (((l) == 64) ? (unsigned long long)(-1LL) : ((1LL << (l)) - 1LL))
 #define bits(x, i, l) (((x) >> (i)) & bitmask(l))
 #define SAMPLED_SET(set) (bits(set, 0, 6) == bits(set, (unsigned long long)(log2(NUM_SET) - 6), 6))
 
+namespace {
+class hawkeye : public replacement::policy {
+    // Per-line state, NUM_SET x NUM_WAY
+    std::vector<uint32_t> rrip;
+    std::vector<bool> prefetching;
+    std::vector<uint32_t> sample_signature; // Hawkeye_Predictor::signature of the filling PC
+
+    // Hawkeye predictors for demand and prefetch requests
+    Hawkeye_Predictor predictor_demand;
+    Hawkeye_Predictor predictor_prefetch;
+
+    // OPTgen for the sampled sets only, at optgen_slot[set] (-1 elsewhere)
+    std::vector<OPTgen> optgen_occup_vector;
+    std::vector<int32_t> optgen_slot;
+    std::vector<SAMPLER_SET> cache_history_sampler;
+    std::vector<uint64_t> set_timer;
+
+public:
+    using policy::policy;
+
+    void initialize_replacement() override;
+    uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) override;
+    void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                  uint8_t hit) override;
+    bool serialize_state(replacement::checkpoint::archive& ar) override {
+        ar(rrip, prefetching, sample_signature, predictor_demand, predictor_prefetch, optgen_occup_vector, cache_history_sampler, set_timer);
+        return true;
+    }
+};
+} // namespace
+
 // Initialize replacement state
-void CACHE::initialize_replacement() {
+void hawkeye::initialize_replacement() {
     std::cout << "Initialize Hawkeye replacement policy state" << std::endl;
 
-    for (int i = 0; i < NUM_SET; i++) {
-        for (int j = 0; j < NUM_WAY; j++) {
-            rrip[i][j] = MAXRRIP;
-            sample_signature[i][j] = 0;
-            prefetching[i][j] = false;
+    rrip.assign(NUM_SET * NUM_WAY, MAXRRIP);
+    sample_signature.assign(NUM_SET * NUM_WAY, 0);
+    prefetching.assign(NUM_SET * NUM_WAY, false);
+    set_timer.assign(NUM_SET, 0);
+    optgen_slot.assign(NUM_SET, -1);
+    for (uint32_t set = 0; set < NUM_SET; set++) {
+        if (SAMPLED_SET(set)) {
+            optgen_slot[set] = static_cast<int32_t>(optgen_occup_vector.size());
+            optgen_occup_vector.emplace_back().init(NUM_WAY - 2);
         }
-        set_timer[i] = 0;
-        optgen_occup_vector[i].init(NUM_WAY - 2);
     }
 
     cache_history_sampler.resize(SAMPLER_SETS);
     for (int i = 0; i < SAMPLER_SETS; i++) {
-        cache_history_sampler[i].clear();
+        cache_history_sampler[i].init();
     }
 
-    predictor_prefetch = new Hawkeye_Predictor();
-    predictor_demand = new Hawkeye_Predictor();
-
     std::cout << "Finished initializing Hawkeye replacement policy state" << std::endl;
 }
 
 // Find replacement victim
-uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) {
+uint32_t hawkeye::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) {
+    uint32_t* set_rrip = &rrip[set * NUM_WAY];
     for (uint32_t i = 0; i < NUM_WAY; i++) {
-        if (rrip[set][i] == MAXRRIP) {
+        if (set_rrip[i] == MAXRRIP) {
             return i;
         }
     }
@@ -79,134 +93,120 @@ uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t
     uint32_t max_rrpv = 0;
     int32_t victim = -1;
     for (uint32_t i = 0; i < NUM_WAY; i++) {
-        if (rrip[set][i] >= max_rrpv) {
-            max_rrpv = rrip[set][i];
+        if (set_rrip[i] >= max_rrpv) {
+            max_rrpv = set_rrip[i];
             victim = i;
         }
     }
 
     if (SAMPLED_SET(set)) {
-        if (prefetching[set][victim]) {
-            predictor_prefetch->decrease(sample_signature[set][victim]);
+        if (prefetching[set * NUM_WAY + victim]) {
+            predictor_prefetch.decrease(sample_signature[set * NUM_WAY + victim]);
         } else {
-            predictor_demand->decrease(sample_signature[set][victim]);
+            predictor_demand.decrease(sample_signature[set * NUM_WAY + victim]);
         }
     }
 
     return victim;
 }
 
-// Helper function to update cache history
-void update_cache_history(unsigned int sample_set, unsigned int currentVal) {
-    for (auto& [key, history] : cache_history_sampler[sample_set]) {
-        if (history.lru < currentVal) {
-            history.lru++;
-        }
-    }
-}
-
 // Update replacement state
-void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
-                                     uint8_t hit) {
+void hawkeye::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                       uint8_t hit) {
     full_addr = (full_addr >> 6) << 6;
+    uint32_t* set_rrip = &rrip[set * NUM_WAY];
 
     // Handle writebacks
     if (type == static_cast<uint32_t>(access_type::WRITE)) {
         return;
     }
 
+    uint32_t signature = Hawkeye_Predictor::signature(ip);
+
     if (type == static_cast<uint32_t>(access_type::PREFETCH)) {
-        prefetching[set][way] = !hit;
+        prefetching[set * NUM_WAY + way] = !hit;
     } else {
-        prefetching[set][way] = false;
+        prefetching[set * NUM_WAY + way] = false;
     }
 
     if (SAMPLED_SET(set)) {
+        OPTgen& optgen = optgen_occup_vector[optgen_slot[set]];
         uint64_t currentVal = set_timer[set] % OPTGEN_SIZE;
-        uint64_t sample_tag = CRC(full_addr >> 12) % 256;
+        uint8_t sample_tag = CRC(full_addr >> 12) % 256;
         uint32_t sample_set = (full_addr >> 6) % SAMPLER_SETS;
+        SAMPLER_SET& sampler = cache_history_sampler[sample_set];
+        int entry = sampler.find(sample_tag);
 
-        if ((type != static_cast<uint32_t>(access_type::PREFETCH)) && cache_history_sampler[sample_set].find(sample_tag) != cache_history_sampler[sample_set].end()) {
+        if ((type != static_cast<uint32_t>(access_type::PREFETCH)) && entry >= 0) {
             unsigned int current_time = set_timer[set];
-            if (current_time < cache_history_sampler[sample_set][sample_tag].previousVal) {
+            if (current_time < sampler.previousVal[entry]) {
                 current_time += TIMER_SIZE;
             }
-            uint64_t previousVal = cache_history_sampler[sample_set][sample_tag].previousVal % OPTGEN_SIZE;
-            bool isWrap = (current_time - cache_history_sampler[sample_set][sample_tag].previousVal) > OPTGEN_SIZE;
+            uint64_t previousVal = sampler.previousVal[entry] % OPTGEN_SIZE;
+            bool isWrap = (current_time - sampler.previousVal[entry]) > OPTGEN_SIZE;
 
-            if (!isWrap && optgen_occup_vector[set].is_cache(currentVal, previousVal)) {
-                if (cache_history_sampler[sample_set][sample_tag].prefetching) {
-                    predictor_prefetch->increase(cache_history_sampler[sample_set][sample_tag].PCval);
+            if (!isWrap && optgen.is_cache(currentVal, previousVal)) {
+                if (sampler.prefetching[entry]) {
+                    predictor_prefetch.increase(sampler.PCval[entry]);
                 } else {
-                    predictor_demand->increase(cache_history_sampler[sample_set][sample_tag].PCval);
+                    predictor_demand.increase(sampler.PCval[entry]);
                 }
             } else {
-                if (cache_history_sampler[sample_set][sample_tag].prefetching) {
-                    predictor_prefetch->decrease(cache_history_sampler[sample_set][sample_tag].PCval);
+                if (sampler.prefetching[entry]) {
+                    predictor_prefetch.decrease(sampler.PCval[entry]);
                 } else {
-                    predictor_demand->decrease(cache_history_sampler[sample_set][sample_tag].PCval);
-                }
-            }
-
-            optgen_occup_vector[set].set_access(currentVal);
-            update_cache_history(sample_set, cache_history_sampler[sample_set][sample_tag].lru);
-            cache_history_sampler[sample_set][sample_tag].prefetching = false;
-        } else if (cache_history_sampler[sample_set].find(sample_tag) == cache_history_sampler[sample_set].end()) {
-            if (cache_history_sampler[sample_set].size() == SAMPLER_HIST) {
-                uint64_t addr_val = 0;
-                for (auto it = cache_history_sampler[sample_set].begin(); it != cache_history_sampler[sample_set].end(); it++) {
-                    if (it->second.lru == SAMPLER_HIST - 1) {
-                        addr_val = it->first;
-                        break;
-                    }
+                    predictor_demand.decrease(sampler.PCval[entry]);
                 }
-                cache_history_sampler[sample_set].erase(addr_val);
             }
 
-            cache_history_sampler[sample_set][sample_tag].init();
+            optgen.set_access(currentVal);
+            sampler.update_lru(sampler.lru[entry]);
+            sampler.prefetching[entry] = false;
+        } else if (entry < 0) {
+            entry = sampler.insert(sample_tag);
             if (type == static_cast<uint32_t>(access_type::PREFETCH)) {
-                cache_history_sampler[sample_set][sample_tag].set_prefetch();
-                optgen_occup_vector[set].set_prefetch(currentVal);
+                sampler.prefetching[entry] = true;
+                optgen.set_prefetch(currentVal);
             } else {
-                optgen_occup_vector[set].set_access(currentVal);
+                optgen.set_access(currentVal);
             }
 
-            update_cache_history(sample_set, SAMPLER_HIST - 1);
+            sampler.update_lru(SAMPLER_HIST - 1);
         }
 
-        cache_history_sampler[sample_set][sample_tag].update(set_timer[set], ip);
-        cache_history_sampler[sample_set][sample_tag].lru = 0;
+        sampler.previousVal[entry] = set_timer[set];
+        sampler.PCval[entry] = signature;
+        sampler.lru[entry] = 0;
         set_timer[set] = (set_timer[set] + 1) % TIMER_SIZE;
     }
 
-    bool prediction = predictor_demand->get_prediction(ip);
+    bool prediction = predictor_demand.get_prediction(signature);
     if (type == static_cast<uint32_t>(access_type::PREFETCH)) {
-        prediction = predictor_prefetch->get_prediction(ip);
+        prediction = predictor_prefetch.get_prediction(signature);
     }
 
-    sample_signature[set][way] = ip;
+    sample_signature[set * NUM_WAY + way] = signature;
 
     if (!prediction) {
-        rrip[set][way] = MAXRRIP;
+        set_rrip[way] = MAXRRIP;
     } else {
-        rrip[set][way] = 0;
+        set_rrip[way] = 0;
         if (!hit) {
             bool isMaxVal = false;
             for (uint32_t i = 0; i < NUM_WAY; i++) {
-                if (rrip[set][i] == MAXRRIP - 1) {
+                if (set_rrip[i] == MAXRRIP - 1) {
                     isMaxVal = true;
                 }
             }
 
             for (uint32_t i = 0; i < NUM_WAY; i++) {
-                if (!isMaxVal && rrip[set][i] < MAXRRIP - 1) {
-                    rrip[set][i]++;
+                if (!isMaxVal && set_rrip[i] < MAXRRIP - 1) {
+                    set_rrip[i]++;
                 }
             }
         }
-        rrip[set][way] = 0;
+        set_rrip[way] = 0;
     }
 }
 
-// Use this function to print out your own stats at the end of simulation
-void CACHE::replacement_final_stats() {}
+REPLACEMENT_LEGACY_HOOKS(hawkeye, )
@@ -2,8 +2,8 @@
 #define HAWKEYE_PREDICTOR_H
 
 using namespace std;
-#include <vector>
-#include <map>
+#include <algorithm>
+#include <cstdint>
 #include "helper_function.h"
 
 #define MAX_PCMAP 31
@@ -11,42 +11,37 @@ using namespace std;
 
 class Hawkeye_Predictor{
 private:
-	map<uint64_t, int> PC_Map;
+	//Saturating counters; every entry starts at the midpoint, which predicts a hit
+	uint8_t PC_Map[PCMAP_SIZE];
 
 public:
-	//Return prediction for PC Address
-	bool get_prediction(uint64_t PC){
-		uint64_t result = CRC(PC) % PCMAP_SIZE;
-		if(PC_Map.find(result) != PC_Map.end() && PC_Map[result] < ((MAX_PCMAP+1)/2)){
-			return false;
-		}
-		return true;
+	Hawkeye_Predictor(){
+		fill(begin(PC_Map), end(PC_Map), (MAX_PCMAP + 1)/2);
 	}
 
-	void increase(uint64_t PC){
-		uint64_t result = CRC(PC) % PCMAP_SIZE;
-		if(PC_Map.find(result) == PC_Map.end()){
-			PC_Map[result] = (MAX_PCMAP + 1)/2;
-		}
+	//Table index for a PC. Compute it once per access and pass it to the
+	//calls below; both the demand and prefetch predictors share it.
+	static uint32_t signature(uint64_t PC){
+		return CRC(PC) % PCMAP_SIZE;
+	}
 
-		if(PC_Map[result] < MAX_PCMAP){
-			PC_Map[result] = PC_Map[result]+1;
-		}
-		else{
-			PC_Map[result] = MAX_PCMAP;
-		}
+	//Return prediction for a PC signature
+	bool get_prediction(uint32_t signature){
+		return PC_Map[signature] >= ((MAX_PCMAP+1)/2);
 	}
 
-	void decrease(uint64_t PC){
-		uint64_t result = CRC(PC) % PCMAP_SIZE;
-		if(PC_Map.find(result) == PC_Map.end()){
-			PC_Map[result] = (MAX_PCMAP + 1)/2;
+	void increase(uint32_t signature){
+		if(PC_Map[signature] < MAX_PCMAP){
+			PC_Map[signature]++;
 		}
-		if(PC_Map[result] != 0){
-			PC_Map[result] = PC_Map[result] - 1;
+	}
+
+	void decrease(uint32_t signature){
+		if(PC_Map[signature] != 0){
+			PC_Map[signature]--;
 		}
 	}
 
 };
 
-#endif
\ No newline at end of file
+#endif
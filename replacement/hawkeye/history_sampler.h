@@ -0,0 +1,77 @@
+#ifndef HISTORY_SAMPLER_H
+#define HISTORY_SAMPLER_H
+
+#include <cstdint>
+#include <cstring>
+
+#define SAMPLER_HIST 8
+
+//History of one sampler set: up to SAMPLER_HIST recently seen tags with the
+//time, PC and LRU position of their last access. Fields are kept as parallel
+//arrays so the tag match and the LRU aging each run over all eight entries at
+//once as 64-bit SWAR operations (lane i is byte i, little-endian).
+struct SAMPLER_SET{
+    uint8_t tag[SAMPLER_HIST];
+    uint8_t lru[SAMPLER_HIST];
+    uint8_t valid[SAMPLER_HIST];    //0xFF for a live entry, 0 otherwise
+    uint8_t prefetching[SAMPLER_HIST];
+    uint32_t previousVal[SAMPLER_HIST];
+    uint32_t PCval[SAMPLER_HIST];   //Hawkeye_Predictor::signature of the last PC
+
+    static constexpr uint64_t ONES = 0x0101010101010101ULL;
+    static constexpr uint64_t LOW7 = 0x7f7f7f7f7f7f7f7fULL;
+    static constexpr uint64_t HIGH = 0x8080808080808080ULL;
+
+    void init(){
+        memset(this, 0, sizeof(*this));
+    }
+
+    //Return the entry holding this tag, or -1
+    int find(uint8_t sample_tag) const{
+        uint64_t tags, live;
+        memcpy(&tags, tag, sizeof(tags));
+        memcpy(&live, valid, sizeof(live));
+
+        //high bit of each byte is set where the tag matches
+        uint64_t diff = tags ^ (ONES * sample_tag);
+        uint64_t match = ~(((diff & LOW7) + LOW7) | diff | LOW7) & live;
+        return match ? __builtin_ctzll(match) / 8 : -1;
+    }
+
+    //Age every live entry younger than currentVal by one
+    void update_lru(uint32_t currentVal){
+        uint64_t ages, live;
+        memcpy(&ages, lru, sizeof(ages));
+        memcpy(&live, valid, sizeof(live));
+
+        //ages stay below SAMPLER_HIST, so no lane borrows from its neighbour
+        uint64_t younger = ((ONES * (0x80 + currentVal - 1)) - ages) & HIGH;
+        ages += (younger >> 7) & live;
+        memcpy(lru, &ages, sizeof(ages));
+    }
+
+    //Claim an entry for a new tag: a free one if any, otherwise the oldest
+    //(lowest tag on a tie), with its history cleared.
+    int insert(uint8_t sample_tag){
+        int way = -1;
+        for(int i = 0; i < SAMPLER_HIST; i++){
+            if(!valid[i]){
+                way = i;
+                break;
+            }
+            if(way < 0 || lru[i] > lru[way] || (lru[i] == lru[way] && tag[i] < tag[way])){
+                way = i;
+            }
+        }
+
+        tag[way] = sample_tag;
+        valid[way] = 0xFF;
+        lru[way] = 0;
+        prefetching[way] = false;
+        previousVal[way] = 0;
+        PCval[way] = 0;
+        return way;
+    }
+};
+
+#endif
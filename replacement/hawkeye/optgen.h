@@ -3,11 +3,30 @@
 
 using namespace std;
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <vector>
+
+#include "../checkpoint.h"
+
+//Length of the OPTgen history window; override with -DOPTGEN_SIZE=... to
+//model a longer window (keep it at or below TIMER_SIZE)
+#ifndef OPTGEN_SIZE
 #define OPTGEN_SIZE 128
+#endif
 
+//Occupancy vector for one set. Liveness intervals are kept in a segment tree
+//with lazy range add, so checking whether an interval fits in the cache and
+//then filling it both cost O(log OPTGEN_SIZE) instead of a walk over the
+//interval. occupancy[node] is the max over the node's range plus the node's
+//own pending add; a leaf holds its value minus the adds pending above it.
+//Nodes are 32-bit: a pending count grows by at most one per access to the
+//set, and the occupancy never exceeds cache_size.
 struct OPTgen{
-    vector<unsigned int> liveness_intervals;
+    vector<int32_t> occupancy;
+    vector<int32_t> pending;
+    size_t leaves;
     uint64_t num_cache;
     uint64_t access;
     uint64_t cache_size;
@@ -17,7 +36,12 @@ struct OPTgen{
         num_cache = 0;
         access = 0;
         cache_size = size;
-        liveness_intervals.resize(OPTGEN_SIZE, 0);
+        leaves = 1;
+        while (leaves < OPTGEN_SIZE){
+            leaves <<= 1;
+        }
+        occupancy.assign(2 * leaves, 0);
+        pending.assign(2 * leaves, 0);
     }
 
     //Return number of hits
@@ -27,35 +51,88 @@ struct OPTgen{
 
     void set_access(uint64_t val){
         access++;
-        liveness_intervals[val] = 0;
+        assign(1, 0, leaves, val, 0);
     }
 
     void set_prefetch(uint64_t val){
-        liveness_intervals[val] = 0;
+        assign(1, 0, leaves, val, 0);
     }
 
     //Return if hit or miss
     bool is_cache(uint64_t val, uint64_t endVal){
-        bool cache = true;
-        unsigned int count = endVal;
-        while (count != val){
-            if(liveness_intervals[count] >= cache_size){
-                cache = false;
-                break;
-            }
-            count = (count+1) % liveness_intervals.size();
-        }
-
-        if(cache){
-            count = endVal;
-            while(count != val){
-                liveness_intervals[count]++;
-                count = (count+1) % liveness_intervals.size();
-            }
-            num_cache++;
-        }
-        return cache;
+        //the interval runs from endVal up to (not including) val, wrapping around
+        int64_t peak;
+        if (endVal <= val){
+            peak = max_in(1, 0, leaves, endVal, val);
+        }
+        else{
+            peak = max(max_in(1, 0, leaves, endVal, OPTGEN_SIZE), max_in(1, 0, leaves, 0, val));
+        }
+
+        if (peak >= static_cast<int64_t>(cache_size)){
+            return false;
+        }
+
+        if (endVal <= val){
+            add_one(1, 0, leaves, endVal, val);
+        }
+        else{
+            add_one(1, 0, leaves, endVal, OPTGEN_SIZE);
+            add_one(1, 0, leaves, 0, val);
+        }
+        num_cache++;
+        return true;
+    }
+
+    void serialize_state(replacement::checkpoint::archive& ar){
+        ar(occupancy, pending, leaves, num_cache, access, cache_size);
+    }
+
+private:
+    void pull(size_t node){
+        occupancy[node] = max(occupancy[2 * node], occupancy[2 * node + 1]) + pending[node];
+    }
+
+    int64_t max_in(size_t node, uint64_t lo, uint64_t hi, uint64_t l, uint64_t r){
+        if (r <= lo || hi <= l){
+            return numeric_limits<int64_t>::min();
+        }
+        if (l <= lo && hi <= r){
+            return occupancy[node];
+        }
+        uint64_t mid = (lo + hi) / 2;
+        return max(max_in(2 * node, lo, mid, l, r), max_in(2 * node + 1, mid, hi, l, r)) + pending[node];
+    }
+
+    void add_one(size_t node, uint64_t lo, uint64_t hi, uint64_t l, uint64_t r){
+        if (r <= lo || hi <= l){
+            return;
+        }
+        if (l <= lo && hi <= r){
+            occupancy[node]++;
+            pending[node]++;
+            return;
+        }
+        uint64_t mid = (lo + hi) / 2;
+        add_one(2 * node, lo, mid, l, r);
+        add_one(2 * node + 1, mid, hi, l, r);
+        pull(node);
+    }
+
+    void assign(size_t node, uint64_t lo, uint64_t hi, uint64_t pos, int64_t value){
+        if (hi - lo == 1){
+            occupancy[node] = static_cast<int32_t>(value);
+            return;
+        }
+        uint64_t mid = (lo + hi) / 2;
+        if (pos < mid){
+            assign(2 * node, lo, mid, pos, value - pending[node]);
+        }
+        else{
+            assign(2 * node + 1, mid, hi, pos, value - pending[node]);
+        }
+        pull(node);
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,186 @@
+#ifndef LRUSTAT_ACCESS_COLUMNS_H
+#define LRUSTAT_ACCESS_COLUMNS_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "access_trace.h"
+
+namespace lrustat
+{
+// Columnar layout of an access stream, made to be mapped and used in place.
+//
+// The file starts with a column_header and a table with one column_entry per
+// column, then holds each column as a plain little-endian array of count
+// values, starting on a 64-byte boundary. Each entry gives the column name,
+// its numpy dtype string and its file offset, so numpy can map a column with
+// np.memmap(path, dtype, 'r', offset, (count,)) and C++ with one mmap of the
+// whole file. tools/lrustat2col writes these files from lruStat traces or the
+// old CSVs, and LRU Predictive Model Code/access_columns.py reads them.
+struct column_header {
+  char magic[8];         // "LRUSTCOL"
+  uint32_t version;      // COLUMN_VERSION
+  uint32_t num_columns;  // entries in the column table that follows
+  uint64_t count;        // values per column
+};
+
+struct column_entry {
+  char name[8];   // NUL-padded
+  char dtype[8];  // numpy dtype string, NUL-padded
+  uint64_t offset;
+};
+
+static_assert(sizeof(column_header) == 24, "column header layout is part of the file format");
+static_assert(sizeof(column_entry) == 24, "column table layout is part of the file format");
+
+constexpr char COLUMN_MAGIC[8] = {'L', 'R', 'U', 'S', 'T', 'C', 'O', 'L'};
+constexpr uint32_t COLUMN_VERSION = 1;
+constexpr uint64_t COLUMN_ALIGN = 64;
+
+enum class column : std::size_t { address, ip, cycle, set, cpu, type, hit, NUM_COLUMNS };
+
+constexpr std::size_t NUM_COLUMNS = static_cast<std::size_t>(column::NUM_COLUMNS);
+
+// Name, dtype and width of each column, in file order (widest first)
+struct column_spec {
+  const char* name;
+  const char* dtype;
+  uint64_t width;
+};
+
+constexpr std::array<column_spec, NUM_COLUMNS> COLUMN_SPECS{{
+    {"address", "<u8", 8},
+    {"ip", "<u8", 8},
+    {"cycle", "<u8", 8},
+    {"set", "<u4", 4},
+    {"cpu", "<u2", 2},
+    {"type", "|u1", 1},
+    {"hit", "|u1", 1},
+}};
+
+constexpr uint64_t align_column(uint64_t offset) { return (offset + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN; }
+
+// Header, column table and column offsets for a file of count accesses; the
+// last offset is the file size
+struct column_layout {
+  column_header header{};
+  std::array<column_entry, NUM_COLUMNS> entries{};
+  uint64_t size = 0;
+
+  explicit column_layout(uint64_t count)
+  {
+    std::memcpy(header.magic, COLUMN_MAGIC, sizeof(header.magic));
+    header.version = COLUMN_VERSION;
+    header.num_columns = NUM_COLUMNS;
+    header.count = count;
+
+    uint64_t offset = align_column(sizeof(header) + sizeof(entries));
+    for (std::size_t i = 0; i < NUM_COLUMNS; ++i) {
+      std::strncpy(entries[i].name, COLUMN_SPECS[i].name, sizeof(entries[i].name));
+      std::strncpy(entries[i].dtype, COLUMN_SPECS[i].dtype, sizeof(entries[i].dtype));
+      entries[i].offset = offset;
+      offset = align_column(offset + count * COLUMN_SPECS[i].width);
+    }
+    size = offset;
+  }
+};
+
+inline bool is_column_file(const std::string& path)
+{
+  char magic[8];
+  std::FILE* in = std::fopen(path.c_str(), "rb");
+  if (in == nullptr)
+    return false;
+  bool match = std::fread(magic, sizeof(magic), 1, in) == 1 && std::memcmp(magic, COLUMN_MAGIC, sizeof(magic)) == 0;
+  std::fclose(in);
+  return match;
+}
+
+// A column file mapped read-only. The columns are used in place; nothing is
+// copied or parsed, and the kernel pages them in as they are touched.
+class column_file
+{
+public:
+  explicit column_file(const std::string& path)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("cannot open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(column_header)) {
+      ::close(fd);
+      throw std::runtime_error(path + " is not an lruStat column file");
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    base_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED)
+      throw std::runtime_error("cannot map " + path);
+
+    const auto* header = static_cast<const column_header*>(base_);
+    column_layout expected{header->count};
+    if (std::memcmp(header, &expected.header, sizeof(expected.header)) != 0 || size_ < expected.size
+        || std::memcmp(header + 1, expected.entries.data(), sizeof(expected.entries)) != 0) {
+      ::munmap(base_, size_);
+      throw std::runtime_error(path + " is not an lruStat column file of version " + std::to_string(COLUMN_VERSION));
+    }
+    count_ = header->count;
+    for (std::size_t i = 0; i < NUM_COLUMNS; ++i)
+      columns_[i] = static_cast<const char*>(base_) + expected.entries[i].offset;
+
+    ::madvise(base_, size_, MADV_SEQUENTIAL);
+  }
+
+  column_file(const column_file&) = delete;
+  column_file& operator=(const column_file&) = delete;
+  ~column_file() { ::munmap(base_, size_); }
+
+  uint64_t size() const { return count_; }
+
+  const uint64_t* address() const { return get<uint64_t>(column::address); }
+  const uint64_t* ip() const { return get<uint64_t>(column::ip); }
+  const uint64_t* cycle() const { return get<uint64_t>(column::cycle); }
+  const uint32_t* set() const { return get<uint32_t>(column::set); }
+  const uint16_t* cpu() const { return get<uint16_t>(column::cpu); }
+  const uint8_t* type() const { return get<uint8_t>(column::type); }
+  const uint8_t* hit() const { return get<uint8_t>(column::hit); }
+
+  // One access put back together as a trace record
+  access_record record(uint64_t i) const
+  {
+    access_record r;
+    r.address = address()[i];
+    r.ip = ip()[i];
+    r.cycle = cycle()[i];
+    r.set = set()[i];
+    r.type = type()[i];
+    r.hit = hit()[i];
+    r.cpu = cpu()[i];
+    return r;
+  }
+
+private:
+  template <typename T>
+  const T* get(column c) const
+  {
+    return reinterpret_cast<const T*>(columns_[static_cast<std::size_t>(c)]);
+  }
+
+  void* base_ = nullptr;
+  std::size_t size_ = 0;
+  uint64_t count_ = 0;
+  std::array<const char*, NUM_COLUMNS> columns_{};
+};
+} // namespace lrustat
+
+#endif
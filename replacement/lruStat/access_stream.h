@@ -0,0 +1,86 @@
+#ifndef LRUSTAT_ACCESS_STREAM_H
+#define LRUSTAT_ACCESS_STREAM_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "access_columns.h"
+#include "trace_reader.h"
+
+namespace lrustat
+{
+// One access stream from several captures, read a block at a time. Each input
+// is a trace or a column file; lruStat writes one trace per CPU, and the
+// inputs are merged by cycle back into the order the cache saw them in.
+class merged_stream
+{
+public:
+  explicit merged_stream(const std::vector<std::string>& paths)
+  {
+    for (const auto& path : paths) {
+      inputs.push_back(std::make_unique<input>(path));
+      inputs.back()->refill();
+    }
+  }
+
+  // Fill records with the next block of the merged stream. Returns false at the end.
+  bool next(std::vector<lrustat::access_record>& records)
+  {
+    records.clear();
+    while (records.size() < BLOCK_RECORDS) {
+      input* earliest = nullptr;
+      for (auto& in : inputs) {
+        if (in->pos < in->records.size() && (earliest == nullptr || in->records[in->pos].cycle < earliest->records[earliest->pos].cycle))
+          earliest = in.get();
+      }
+      if (earliest == nullptr)
+        break;
+
+      records.push_back(earliest->records[earliest->pos++]);
+      if (earliest->pos == earliest->records.size())
+        earliest->refill();
+    }
+    return !records.empty();
+  }
+
+private:
+  static constexpr std::size_t BLOCK_RECORDS = std::size_t{1} << 16;
+
+  // A trace read a block at a time, or a column file mapped in place
+  struct input {
+    std::unique_ptr<lrustat::trace_reader> reader;
+    std::unique_ptr<lrustat::column_file> columns;
+    uint64_t next_column = 0;
+    std::vector<lrustat::access_record> records;
+    std::size_t pos = 0;
+
+    explicit input(const std::string& path)
+    {
+      if (lrustat::is_column_file(path))
+        columns = std::make_unique<lrustat::column_file>(path);
+      else
+        reader = std::make_unique<lrustat::trace_reader>(path);
+    }
+
+    void refill()
+    {
+      pos = 0;
+      if (reader) {
+        if (!reader->next(records))
+          records.clear();
+        return;
+      }
+
+      records.clear();
+      for (; next_column < columns->size() && records.size() < BLOCK_RECORDS; ++next_column)
+        records.push_back(columns->record(next_column));
+    }
+  };
+
+  std::vector<std::unique_ptr<input>> inputs;
+};
+} // namespace lrustat
+
+#endif
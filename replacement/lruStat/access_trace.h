@@ -0,0 +1,165 @@
+#ifndef LRUSTAT_ACCESS_TRACE_H
+#define LRUSTAT_ACCESS_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(LRUSTAT_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(LRUSTAT_XZ)
+#include <lzma.h>
+#endif
+
+// On-disk format of the lruStat access trace, shared by the writer in the
+// replacement policy and by the tools that read the trace back.
+//
+// A trace is a file_header followed by access_records. With codec::none the
+// records follow the header directly, so the file can be read as a flat array.
+// With a compressor, the records are cut into blocks and each block is stored
+// as a block_header followed by its compressed bytes.
+//
+// Compression is chosen at build time: -DLRUSTAT_ZSTD (link -lzstd) or
+// -DLRUSTAT_XZ (link -llzma). zstd keeps up with the simulator; xz gives a
+// slightly smaller file but is slow enough that the simulator ends up waiting
+// on it, so use it for traces that will be archived. A reader has to be built
+// with the codec the trace was written with.
+namespace lrustat
+{
+constexpr char TRACE_MAGIC[8] = {'L', 'R', 'U', 'S', 'T', 'A', 'T', '\0'};
+constexpr uint32_t TRACE_VERSION = 1;
+
+enum class codec : uint32_t { none = 0, zstd = 1, xz = 2 };
+
+#if defined(LRUSTAT_ZSTD)
+constexpr codec default_codec = codec::zstd;
+#elif defined(LRUSTAT_XZ)
+constexpr codec default_codec = codec::xz;
+#else
+constexpr codec default_codec = codec::none;
+#endif
+
+struct file_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t codec;
+  uint32_t reserved;
+};
+
+// One LLC access. type holds the access_type enum value
+// (LOAD, RFO, PREFETCH, WRITE, TRANSLATION).
+struct access_record {
+  uint64_t address;
+  uint64_t ip;
+  uint64_t cycle;
+  uint32_t set;
+  uint8_t type;
+  uint8_t hit;
+  uint16_t cpu;
+};
+
+struct block_header {
+  uint32_t raw_bytes;
+  uint32_t stored_bytes;
+};
+
+static_assert(sizeof(file_header) == 24, "file_header layout is part of the trace format");
+static_assert(sizeof(access_record) == 32, "access_record layout is part of the trace format");
+static_assert(sizeof(block_header) == 8, "block_header layout is part of the trace format");
+
+constexpr const char* ACCESS_TYPE_NAMES[] = {"LOAD", "RFO", "PREFETCH", "WRITE", "TRANSLATION"};
+constexpr uint8_t ACCESS_TYPE_WRITE = 3;
+
+inline file_header make_header(codec c)
+{
+  file_header header{};
+  std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+  header.version = TRACE_VERSION;
+  header.record_size = sizeof(access_record);
+  header.codec = static_cast<uint32_t>(c);
+  return header;
+}
+
+inline bool valid_header(const file_header& header)
+{
+  return std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) == 0 && header.version == TRACE_VERSION
+         && header.record_size == sizeof(access_record);
+}
+
+inline bool codec_supported(codec c)
+{
+  switch (c) {
+  case codec::none:
+    return true;
+#if defined(LRUSTAT_ZSTD)
+  case codec::zstd:
+    return true;
+#endif
+#if defined(LRUSTAT_XZ)
+  case codec::xz:
+    return true;
+#endif
+  default:
+    return false;
+  }
+}
+
+// Compress raw_bytes from src into out. Returns false if the codec is not built in or fails.
+inline bool compress_block(codec c, const void* src, std::size_t raw_bytes, std::vector<char>& out)
+{
+  switch (c) {
+#if defined(LRUSTAT_ZSTD)
+  case codec::zstd: {
+    out.resize(ZSTD_compressBound(raw_bytes));
+    std::size_t n = ZSTD_compress(out.data(), out.size(), src, raw_bytes, 3);
+    if (ZSTD_isError(n))
+      return false;
+    out.resize(n);
+    return true;
+  }
+#endif
+#if defined(LRUSTAT_XZ)
+  case codec::xz: {
+    out.resize(lzma_stream_buffer_bound(raw_bytes));
+    std::size_t n = 0;
+    if (lzma_easy_buffer_encode(0, LZMA_CHECK_NONE, nullptr, static_cast<const uint8_t*>(src), raw_bytes,
+                                reinterpret_cast<uint8_t*>(out.data()), &n, out.size())
+        != LZMA_OK)
+      return false;
+    out.resize(n);
+    return true;
+  }
+#endif
+  default:
+    return false;
+  }
+}
+
+// Decompress a block into dst, which must hold exactly raw_bytes.
+inline bool decompress_block(codec c, const void* src, std::size_t stored_bytes, void* dst, std::size_t raw_bytes)
+{
+  switch (c) {
+#if defined(LRUSTAT_ZSTD)
+  case codec::zstd:
+    return ZSTD_decompress(dst, raw_bytes, src, stored_bytes) == raw_bytes;
+#endif
+#if defined(LRUSTAT_XZ)
+  case codec::xz: {
+    uint64_t memlimit = UINT64_MAX;
+    std::size_t in_pos = 0, out_pos = 0;
+    return lzma_stream_buffer_decode(&memlimit, 0, nullptr, static_cast<const uint8_t*>(src), &in_pos, stored_bytes,
+                                     static_cast<uint8_t*>(dst), &out_pos, raw_bytes)
+               == LZMA_OK
+           && out_pos == raw_bytes;
+  }
+#endif
+  default:
+    return false;
+  }
+}
+} // namespace lrustat
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef LRUSTAT_CAPTURE_FILTER_H
+#define LRUSTAT_CAPTURE_FILTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "access_trace.h"
+
+namespace lrustat
+{
+// Decides which accesses make it into the trace. Everything is read from the
+// environment when the cache initializes; with none of these set, every access
+// is logged, as before.
+//
+//   LRUSTAT_SAMPLE_SETS=N      log only N sets, picked like the SHiP sampler sets
+//   LRUSTAT_SKIP_WARMUP=1      drop accesses made during warmup
+//   LRUSTAT_CYCLE_BEGIN=C      drop accesses before cycle C
+//   LRUSTAT_CYCLE_END=C        drop accesses at or after cycle C
+//   LRUSTAT_TYPES=LOAD,WRITE   log only these access types (names as in ACCESS_TYPE_NAMES)
+//   LRUSTAT_HITS=hit|miss|all  log only hits, only misses, or both
+class capture_filter
+{
+public:
+  static capture_filter from_environment(std::size_t num_set)
+  {
+    capture_filter filter;
+
+    if (const char* sets = std::getenv("LRUSTAT_SAMPLE_SETS")) {
+      std::size_t count = parse_number("LRUSTAT_SAMPLE_SETS", sets);
+      if (count > 0 && count < num_set)
+        filter.sample_sets(num_set, count);
+    }
+
+    if (const char* skip = std::getenv("LRUSTAT_SKIP_WARMUP"))
+      filter.skip_warmup = std::string{skip} != "0";
+    if (const char* begin = std::getenv("LRUSTAT_CYCLE_BEGIN"))
+      filter.cycle_begin = parse_number("LRUSTAT_CYCLE_BEGIN", begin);
+    if (const char* end = std::getenv("LRUSTAT_CYCLE_END"))
+      filter.cycle_end = parse_number("LRUSTAT_CYCLE_END", end);
+
+    uint32_t type_mask = ALL_TYPES;
+    if (const char* types = std::getenv("LRUSTAT_TYPES"))
+      type_mask = parse_types(types);
+
+    unsigned hit_values = 0b11; // bit 0 for misses, bit 1 for hits
+    if (const char* hits = std::getenv("LRUSTAT_HITS")) {
+      std::string value{hits};
+      if (value == "hit")
+        hit_values = 0b10;
+      else if (value == "miss")
+        hit_values = 0b01;
+      else if (value != "all")
+        throw std::runtime_error("lruStat: LRUSTAT_HITS must be hit, miss or all, not " + value);
+    }
+
+    filter.accepted = 0;
+    for (unsigned type = 0; type < NUM_TYPES; ++type)
+      for (unsigned hit = 0; hit < 2; ++hit)
+        if ((type_mask >> type & 1) && (hit_values >> hit & 1))
+          filter.accepted |= 1u << (2 * type + hit);
+
+    return filter;
+  }
+
+  // Called first on every access, so everything here is a compare or a table lookup
+  bool accepts(uint32_t set, uint64_t cycle, bool warmup, uint32_t type, uint8_t hit) const
+  {
+    if (type >= NUM_TYPES || !(accepted >> (2 * type + (hit ? 1 : 0)) & 1))
+      return false;
+    if (cycle < cycle_begin || cycle >= cycle_end || (warmup && skip_warmup))
+      return false;
+    return logged_sets.empty() || logged_sets[set];
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const capture_filter& filter)
+  {
+    os << "sets: ";
+    if (filter.logged_sets.empty())
+      os << "all";
+    else
+      os << std::count(std::begin(filter.logged_sets), std::end(filter.logged_sets), 1) << " sampled";
+    os << " cycles: [" << filter.cycle_begin << ", ";
+    if (filter.cycle_end == std::numeric_limits<uint64_t>::max())
+      os << "end)";
+    else
+      os << filter.cycle_end << ")";
+    os << (filter.skip_warmup ? " warmup: skipped" : " warmup: logged");
+    os << " accepted type/hit mask: 0x" << std::hex << filter.accepted << std::dec;
+    return os;
+  }
+
+private:
+  static constexpr unsigned NUM_TYPES = std::size(ACCESS_TYPE_NAMES);
+  static constexpr uint32_t ALL_TYPES = (1u << NUM_TYPES) - 1;
+
+  // Same generator and duplicate skipping as the SHiP sampler sets
+  void sample_sets(std::size_t num_set, std::size_t count)
+  {
+    logged_sets.assign(num_set, 0);
+    std::size_t rand_seed = 1103515245 + 12345;
+    for (std::size_t i = 0; i < count; i++) {
+      std::size_t val = (rand_seed / 65536) % num_set;
+      while (logged_sets[val]) {
+        rand_seed = rand_seed * 1103515245 + 12345;
+        val = (rand_seed / 65536) % num_set;
+      }
+      logged_sets[val] = 1;
+    }
+  }
+
+  static uint64_t parse_number(const char* name, const char* value)
+  {
+    char* end = nullptr;
+    uint64_t result = std::strtoull(value, &end, 0);
+    if (end == value || *end != '\0')
+      throw std::runtime_error(std::string{"lruStat: "} + name + " is not a number: " + value);
+    return result;
+  }
+
+  static uint32_t parse_types(const std::string& list)
+  {
+    uint32_t mask = 0;
+    std::size_t begin = 0;
+    while (begin <= list.size()) {
+      std::size_t end = std::min(list.find(',', begin), list.size());
+      std::string name = list.substr(begin, end - begin);
+      auto found = std::find_if(std::begin(ACCESS_TYPE_NAMES), std::end(ACCESS_TYPE_NAMES), [&](const char* n) { return name == n; });
+      if (found == std::end(ACCESS_TYPE_NAMES))
+        throw std::runtime_error("lruStat: unknown access type in LRUSTAT_TYPES: " + name);
+      mask |= 1u << std::distance(std::begin(ACCESS_TYPE_NAMES), found);
+      begin = end + 1;
+    }
+    return mask;
+  }
+
+  std::vector<uint8_t> logged_sets; // empty when every set is logged
+  uint64_t cycle_begin = 0;
+  uint64_t cycle_end = std::numeric_limits<uint64_t>::max();
+  bool skip_warmup = false;
+  uint32_t accepted = 0; // bit 2*type+hit is set for logged (type, hit) pairs
+};
+} // namespace lrustat
+
+#endif
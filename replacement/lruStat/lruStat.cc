@@ -1,36 +1,68 @@
 #include <algorithm>
 #include <cassert>
-#include <map>
+#include <iostream>
+#include <memory>
+#include <string>
 #include <vector>
-#include <fstream> // For writing to a file
 
 #include "cache.h"
-
-// Define global variables to store cache access data
-std::map<CACHE*, std::vector<uint64_t>> last_used_cycles;
-std::map<CACHE*, std::vector<uint64_t>> eviction_cycles;
+#include "../policy.h"
+#include "capture_filter.h"
+#include "trace_writer.h"
 
 namespace
 {
-    std::ofstream csv_file("cache_access_data.csv");  // Open CSV file to log data
+    // What one cache logs: its capture filter, and one binary trace per
+    // triggering CPU, each with its own buffer and writer thread. Traces are
+    // opened on first use as <trace_prefix>_cpu<N>.bin; tools/lrustat2csv turns
+    // them back into the old CSV.
+    struct capture {
+        lrustat::capture_filter filter;
+        std::string prefix;
+        std::vector<std::unique_ptr<lrustat::trace_writer>> traces;
 
-    // Write header to the CSV file
-    void write_csv_header() {
-        csv_file << "Memory Address,Cache Set,Access Type,Cycle Count,Data Size,Hit/Miss\n";
-    }
+        capture(const CACHE& cache)
+            : filter(lrustat::capture_filter::from_environment(cache.NUM_SET)), prefix(lrustat::trace_prefix(cache.NAME)), traces(NUM_CPUS)
+        {
+        }
+
+        lrustat::trace_writer& trace(uint32_t cpu) {
+            auto& writer = traces.at(cpu);
+            if (!writer)
+                writer = std::make_unique<lrustat::trace_writer>(prefix + "_cpu" + std::to_string(cpu) + ".bin");
+            return *writer;
+        }
+    };
+
+    class lru_stat : public replacement::policy {
+        // Cache access data
+        std::vector<uint64_t> last_used_cycles;
+        std::vector<uint64_t> eviction_cycles;
+
+        capture cap;
+
+    public:
+        explicit lru_stat(CACHE* cache) : policy(cache), cap(*cache) {}
+
+        void initialize_replacement() override;
+        uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t full_addr, uint64_t pc, uint32_t type) override;
+        void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t pc, uint64_t victim_addr, uint32_t type, uint8_t hit) override;
+        void replacement_final_stats() override;
+    };
 }
 
 // Initialize replacement state
-void CACHE::repl_replacementDlruStat_initialize_replacement() {
-    last_used_cycles[this] = std::vector<uint64_t>(NUM_SET * NUM_WAY, 0);
-    eviction_cycles[this] = std::vector<uint64_t>(NUM_SET * NUM_WAY, 0);
-    write_csv_header();  // Write CSV header at initialization
+void lru_stat::initialize_replacement() {
+    last_used_cycles = std::vector<uint64_t>(NUM_SET * NUM_WAY, 0);
+    eviction_cycles = std::vector<uint64_t>(NUM_SET * NUM_WAY, 0);
+
+    std::cout << NAME << " lruStat capture to " << cap.prefix << "_cpu*.bin, " << cap.filter << std::endl;
 }
 
 // Find victim for replacement based on LRU policy
-uint32_t CACHE::repl_replacementDlruStat_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t full_addr, uint64_t /* pc */, uint32_t type)
+uint32_t lru_stat::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t full_addr, uint64_t /* pc */, uint32_t type)
 {
-    auto begin = std::next(std::begin(last_used_cycles[this]), set * NUM_WAY);
+    auto begin = std::next(std::begin(last_used_cycles), set * NUM_WAY);
     auto end = std::next(begin, NUM_WAY);
 
     // Find the least recently used cache line
@@ -41,32 +73,37 @@ uint32_t CACHE::repl_replacementDlruStat_find_victim(uint32_t triggering_cpu, ui
     uint32_t victim_way = static_cast<uint32_t>(std::distance(begin, victim));
     
     // Log the eviction cycle for the selected victim
-    eviction_cycles[this].at(set * NUM_WAY + victim_way) = current_cycle;
+    eviction_cycles.at(set * NUM_WAY + victim_way) = current_cycle;
 
     return victim_way; // cast protected by prior asserts
 }
 
-// Update replacement state and log the data to CSV
-void CACHE::repl_replacementDlruStat_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t /* pc */, uint64_t victim_addr, uint32_t type, uint8_t hit)
+// Update replacement state and log the access
+void lru_stat::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t pc, uint64_t victim_addr, uint32_t type, uint8_t hit)
 {
-    // Determine access type (read/write)
-    bool is_write = (static_cast<access_type>(type) == access_type::WRITE);
-    std::string access_type_str = is_write ? "WRITE" : "READ";
-
-    // Use fixed data size or retrieve if available in the trace
-    uint32_t data_size = 64;  // Example: assuming 64 bytes; replace if your trace has data size info
-
-    // Log only the relevant trace data and hit/miss status, excluding the PC
-    csv_file << full_addr << "," << set << "," << access_type_str << ","
-             << current_cycle << "," << data_size << ","
-             << static_cast<int>(hit) << "\n";
+    // Log the access; the record is only copied here and written out in the background
+    if (cap.filter.accepts(set, current_cycle, warmup, type, hit)) {
+        lrustat::access_record record;
+        record.address = full_addr;
+        record.ip = pc;
+        record.cycle = current_cycle;
+        record.set = set;
+        record.type = static_cast<uint8_t>(type);
+        record.hit = hit;
+        record.cpu = static_cast<uint16_t>(triggering_cpu);
+        cap.trace(triggering_cpu).append(record);
+    }
 
     // Update last used cycle for this way in the set
-    last_used_cycles[this].at(set * NUM_WAY + way) = current_cycle;
+    last_used_cycles.at(set * NUM_WAY + way) = current_cycle;
 }
 
 // Collect final statistics (optional for this case)
-void CACHE::repl_replacementDlruStat_replacement_final_stats() {
-    // Optional: Include final statistics if needed
-    // This function is a placeholder and can remain empty if no final stats are required.
+void lru_stat::replacement_final_stats() {
+    // Make sure the whole trace is on disk before the simulator exits
+    for (auto& writer : cap.traces)
+        if (writer)
+            writer->flush();
 }
+
+REPLACEMENT_LEGACY_HOOKS(lru_stat, repl_replacementDlruStat_)
@@ -0,0 +1,73 @@
+#ifndef LRUSTAT_TRACE_READER_H
+#define LRUSTAT_TRACE_READER_H
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "access_trace.h"
+
+namespace lrustat
+{
+// Sequential reader for an access trace written by trace_writer. Records come
+// back a block at a time; compressed blocks are decompressed on the way.
+class trace_reader
+{
+public:
+  explicit trace_reader(const std::string& path) : path_(path)
+  {
+    in_ = std::fopen(path_.c_str(), "rb");
+    if (in_ == nullptr)
+      throw std::runtime_error("cannot open " + path_);
+
+    file_header header;
+    if (std::fread(&header, sizeof(header), 1, in_) != 1 || !valid_header(header)) {
+      std::fclose(in_);
+      throw std::runtime_error(path_ + " is not an lruStat trace");
+    }
+    codec_ = static_cast<codec>(header.codec);
+    if (!codec_supported(codec_)) {
+      std::fclose(in_);
+      throw std::runtime_error(path_ + " is compressed with a codec this build does not include");
+    }
+  }
+
+  trace_reader(const trace_reader&) = delete;
+  trace_reader& operator=(const trace_reader&) = delete;
+  ~trace_reader() { std::fclose(in_); }
+
+  // Read the next block of records into records. Returns false at the end of the trace.
+  bool next(std::vector<access_record>& records)
+  {
+    if (codec_ == codec::none) {
+      records.resize(RECORDS_PER_READ);
+      records.resize(std::fread(records.data(), sizeof(access_record), records.size(), in_));
+      return !records.empty();
+    }
+
+    block_header block;
+    if (std::fread(&block, sizeof(block), 1, in_) != 1)
+      return false;
+
+    stored_.resize(block.stored_bytes);
+    records.resize(block.raw_bytes / sizeof(access_record));
+    if (std::fread(stored_.data(), 1, stored_.size(), in_) != stored_.size()
+        || !decompress_block(codec_, stored_.data(), stored_.size(), records.data(), block.raw_bytes))
+      throw std::runtime_error(path_ + " has a truncated or corrupt block");
+    return true;
+  }
+
+  const std::string& path() const { return path_; }
+
+private:
+  static constexpr std::size_t RECORDS_PER_READ = std::size_t{1} << 16;
+
+  std::string path_;
+  std::FILE* in_ = nullptr;
+  codec codec_ = codec::none;
+  std::vector<char> stored_;
+};
+} // namespace lrustat
+
+#endif
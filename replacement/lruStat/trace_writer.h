@@ -0,0 +1,183 @@
+#ifndef LRUSTAT_TRACE_WRITER_H
+#define LRUSTAT_TRACE_WRITER_H
+
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "access_trace.h"
+
+namespace lrustat
+{
+// Buffered writer for an access trace.
+//
+// append() only copies the record into the active buffer. When that buffer
+// fills up it is handed to a background thread, which compresses and writes it
+// while the simulator keeps filling the other buffer. The simulator only waits
+// if it fills a buffer before the previous one has been written.
+class trace_writer
+{
+public:
+  static constexpr std::size_t BUFFER_RECORDS = std::size_t{1} << 16; // 2 MiB per buffer
+
+  explicit trace_writer(const std::string& path, codec c = default_codec) : path_(path), codec_(c)
+  {
+    if (!codec_supported(codec_))
+      throw std::runtime_error("lruStat: trace codec not built in for " + path_);
+
+    out_ = std::fopen(path_.c_str(), "wb");
+    if (out_ == nullptr)
+      throw std::runtime_error("lruStat: cannot open " + path_);
+
+    file_header header = make_header(codec_);
+    write_bytes(&header, sizeof(header));
+
+    active_.resize(BUFFER_RECORDS);
+    pending_.resize(BUFFER_RECORDS);
+    worker_ = std::thread([this] { run(); });
+  }
+
+  trace_writer(const trace_writer&) = delete;
+  trace_writer& operator=(const trace_writer&) = delete;
+
+  ~trace_writer()
+  {
+    flush();
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    worker_.join();
+    std::fclose(out_);
+  }
+
+  void append(const access_record& record)
+  {
+    if (fill_ == BUFFER_RECORDS)
+      hand_off();
+    active_[fill_++] = record;
+  }
+
+  // Write out everything appended so far
+  void flush()
+  {
+    if (fill_ > 0)
+      hand_off();
+
+    std::unique_lock<std::mutex> lock{mutex_};
+    wake_.wait(lock, [this] { return pending_fill_ == 0; });
+    std::fflush(out_);
+  }
+
+  const std::string& path() const { return path_; }
+
+private:
+  void hand_off()
+  {
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      wake_.wait(lock, [this] { return pending_fill_ == 0; });
+      std::swap(active_, pending_);
+      pending_fill_ = fill_;
+    }
+    fill_ = 0;
+    wake_.notify_all();
+  }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+      wake_.wait(lock, [this] { return pending_fill_ > 0 || stopping_; });
+      if (pending_fill_ == 0)
+        return;
+
+      std::size_t count = pending_fill_;
+      lock.unlock();
+      write_records(pending_.data(), count);
+      lock.lock();
+
+      pending_fill_ = 0;
+      wake_.notify_all();
+    }
+  }
+
+  void write_records(const access_record* records, std::size_t count)
+  {
+    std::size_t raw_bytes = count * sizeof(access_record);
+    if (codec_ == codec::none) {
+      write_bytes(records, raw_bytes);
+      return;
+    }
+
+    if (!compress_block(codec_, records, raw_bytes, scratch_)) {
+      report_failure("compression failed");
+      return;
+    }
+    block_header block{static_cast<uint32_t>(raw_bytes), static_cast<uint32_t>(scratch_.size())};
+    write_bytes(&block, sizeof(block));
+    write_bytes(scratch_.data(), scratch_.size());
+  }
+
+  void write_bytes(const void* data, std::size_t size)
+  {
+    if (std::fwrite(data, 1, size, out_) != size)
+      report_failure("write failed");
+  }
+
+  void report_failure(const char* what)
+  {
+    if (!failed_)
+      std::cerr << "lruStat: " << what << " on " << path_ << ", trace is incomplete" << std::endl;
+    failed_ = true;
+  }
+
+  std::string path_;
+  codec codec_;
+  std::FILE* out_ = nullptr;
+
+  std::vector<access_record> active_;
+  std::size_t fill_ = 0;
+
+  // guarded by mutex_; pending_fill_ > 0 while the background thread owns pending_
+  std::vector<access_record> pending_;
+  std::size_t pending_fill_ = 0;
+  bool stopping_ = false;
+
+  std::vector<char> scratch_;
+  bool failed_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread worker_;
+};
+
+// Common start of the trace file names for one cache:
+// <LRUSTAT_DIR>/lrustat_<LRUSTAT_RUN_ID>_<cache name>. The run ID defaults to
+// the process ID, so runs sharing a directory never write to the same file.
+inline std::string trace_prefix(const std::string& cache_name)
+{
+  const char* dir = std::getenv("LRUSTAT_DIR");
+  const char* run_id = std::getenv("LRUSTAT_RUN_ID");
+
+  std::string prefix = dir != nullptr && *dir != '\0' ? std::string{dir} + "/" : std::string{};
+  prefix += "lrustat_";
+  prefix += run_id != nullptr && *run_id != '\0' ? std::string{run_id} : std::to_string(getpid());
+  prefix += "_";
+  for (char c : cache_name)
+    prefix += (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '.') ? c : '_';
+  return prefix;
+}
+} // namespace lrustat
+
+#endif
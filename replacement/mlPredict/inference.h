@@ -0,0 +1,374 @@
+#ifndef MLPREDICT_INFERENCE_H
+#define MLPREDICT_INFERENCE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) && !defined(MLPREDICT_SCALAR)
+#include <immintrin.h>
+#endif
+
+// A small inference engine for the hit/miss predictors trained in
+// "LRU Predictive Model Code", with no runtime beyond the standard library.
+//
+// A model is a feature scaler, at most one LSTM layer and a stack of dense
+// layers, read from the text file that export_model.py writes:
+//
+//   mlpredict 1
+//   features <name>...      inputs per access, in training order
+//   history <n>             accesses per input sequence (1 without an LSTM)
+//   output <index>          element of the last layer that predicts a hit
+//   threshold <value>       predicted hit above this
+//   scale <n>               then n offsets, then n factors: x' = (x - offset) * factor
+//   lstm <in> <units> <activation>
+//                           then the Keras kernel [in][4 units], recurrent
+//                           kernel [units][4 units] and bias [4 units],
+//                           gates in Keras order (i, f, c, o)
+//   dense <in> <out> <activation>
+//                           then the Keras kernel [in][out] and bias [out]
+//   end
+//
+// Activations are linear, relu, sigmoid or tanh. Weights keep the Keras
+// layout, one row per input, and a layer adds each input times its row to
+// all the outputs at once: the layers here are narrow (6 inputs, 50 units)
+// but wide in outputs (200 LSTM gates), so this vectorizes far better than a
+// dot product per output. With precision::int8 the weights of each output are
+// quantized symmetrically with their own scale, and each input vector with one
+// scale per call; products accumulate exactly in int32. The kernels use AVX2
+// when the build enables it (define MLPREDICT_SCALAR to force the scalar
+// code); the int8 sums are the same either way.
+namespace mlpredict
+{
+enum class precision { fp32, int8 };
+enum class activation { linear, relu, sigmoid, tanh };
+
+namespace kernel
+{
+// y += a * x
+inline void axpy(float a, const float* x, float* y, std::size_t n)
+{
+  std::size_t i = 0;
+#if defined(__AVX2__) && !defined(MLPREDICT_SCALAR)
+  const __m256 va = _mm256_set1_ps(a);
+  for (; i + 8 <= n; i += 8) {
+#if defined(__FMA__)
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+#else
+    _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+#endif
+  }
+#endif
+  for (; i < n; ++i)
+    y[i] += a * x[i];
+}
+
+// y += a * x, exactly: both factors are within +-127, so each product fits in 16 bits
+inline void axpy(int8_t a, const int8_t* x, int32_t* y, std::size_t n)
+{
+  std::size_t i = 0;
+#if defined(__AVX2__) && !defined(MLPREDICT_SCALAR)
+  const __m256i va = _mm256_set1_epi16(a);
+  for (; i + 16 <= n; i += 16) {
+    __m256i product = _mm256_mullo_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i))));
+    __m256i low = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(product));
+    __m256i high = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(product, 1));
+    auto* out = reinterpret_cast<__m256i*>(y + i);
+    _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out), low));
+    _mm256_storeu_si256(out + 1, _mm256_add_epi32(_mm256_loadu_si256(out + 1), high));
+  }
+#endif
+  for (; i < n; ++i)
+    y[i] += int32_t{a} * int32_t{x[i]};
+}
+
+// Symmetric int8 quantization of v; returns the scale to multiply back by
+inline float quantize(const float* v, std::size_t n, int8_t* out)
+{
+  float max_abs = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    max_abs = std::max(max_abs, std::fabs(v[i]));
+  float scale = max_abs > 0 ? max_abs / 127 : 1;
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = static_cast<int8_t>(std::lround(v[i] / scale));
+  return scale;
+}
+} // namespace kernel
+
+inline float activate(activation a, float x)
+{
+  switch (a) {
+  case activation::relu:
+    return std::max(x, 0.0f);
+  case activation::sigmoid:
+    return 1 / (1 + std::exp(-x));
+  case activation::tanh:
+    return std::tanh(x);
+  default:
+    return x;
+  }
+}
+
+// A Keras weight matrix, one row per input, in fp32 and, if asked, int8
+class matrix
+{
+public:
+  std::size_t rows = 0; // inputs
+  std::size_t cols = 0; // outputs
+
+  matrix() = default;
+
+  matrix(std::vector<float> keras, std::size_t in, std::size_t out, precision p) : rows(in), cols(out), weights(std::move(keras)), int8(p == precision::int8)
+  {
+    if (!int8)
+      return;
+
+    // One scale per output, over that output's column
+    col_scales.resize(cols);
+    std::vector<float> column(rows);
+    std::vector<int8_t> quantized_column(rows);
+    quantized.resize(weights.size());
+    for (std::size_t c = 0; c < cols; ++c) {
+      for (std::size_t r = 0; r < rows; ++r)
+        column[r] = weights[r * cols + c];
+      col_scales[c] = kernel::quantize(column.data(), rows, quantized_column.data());
+      for (std::size_t r = 0; r < rows; ++r)
+        quantized[r * cols + c] = quantized_column[r];
+    }
+  }
+
+  std::size_t bytes() const { return int8 ? quantized.size() + col_scales.size() * sizeof(float) : weights.size() * sizeof(float); }
+
+  // out += x . matrix, one weight row per input added across all outputs
+  void multiply_add(const float* x, float* out, std::vector<int8_t>& x_quantized, std::vector<int32_t>& sums) const
+  {
+    if (!int8) {
+      for (std::size_t r = 0; r < rows; ++r)
+        kernel::axpy(x[r], &weights[r * cols], out, cols);
+      return;
+    }
+
+    x_quantized.resize(rows);
+    float x_scale = kernel::quantize(x, rows, x_quantized.data());
+    sums.assign(cols, 0);
+    for (std::size_t r = 0; r < rows; ++r)
+      if (x_quantized[r] != 0)
+        kernel::axpy(x_quantized[r], &quantized[r * cols], sums.data(), cols);
+    for (std::size_t c = 0; c < cols; ++c)
+      out[c] += static_cast<float>(sums[c]) * col_scales[c] * x_scale;
+  }
+
+private:
+  std::vector<float> weights;
+  bool int8 = false;
+  std::vector<int8_t> quantized;
+  std::vector<float> col_scales;
+};
+
+struct dense_layer {
+  matrix kernel;
+  std::vector<float> bias;
+  activation act = activation::linear;
+};
+
+struct lstm_layer {
+  std::size_t units = 0;
+  matrix kernel;    // in x 4 units
+  matrix recurrent; // units x 4 units
+  std::vector<float> bias;
+  activation act = activation::linear;
+};
+
+class model
+{
+public:
+  std::vector<std::string> features;
+  std::size_t history = 1;
+  std::size_t output = 0;
+  float threshold = 0.5f;
+
+  model(const std::string& path, precision p)
+  {
+    std::ifstream in{path};
+    if (!in)
+      throw std::runtime_error("cannot open model " + path);
+
+    std::string word;
+    int version = 0;
+    if (!(in >> word >> version) || word != "mlpredict" || version != 1)
+      throw std::runtime_error(path + " is not an mlpredict model of version 1");
+
+    std::size_t width = 0; // of the values flowing into the next layer
+    while (in >> word && word != "end") {
+      if (word == "features") {
+        std::size_t n = 0;
+        in >> n;
+        features.resize(n);
+        for (auto& name : features)
+          in >> name;
+        width = n;
+      } else if (word == "history") {
+        in >> history;
+      } else if (word == "output") {
+        in >> output;
+      } else if (word == "threshold") {
+        in >> threshold;
+      } else if (word == "scale") {
+        std::size_t n = read_size(in, path);
+        offsets = read_values<double>(in, n, path);
+        factors = read_values<double>(in, n, path);
+        expect(n == width, path, "scale does not match the features");
+      } else if (word == "lstm") {
+        expect(!lstm && dense.empty(), path, "the LSTM has to come before the dense layers");
+        std::size_t n_in = read_size(in, path);
+        lstm_layer layer;
+        layer.units = read_size(in, path);
+        layer.act = read_activation(in, path);
+        layer.kernel = matrix(read_values<float>(in, n_in * 4 * layer.units, path), n_in, 4 * layer.units, p);
+        layer.recurrent = matrix(read_values<float>(in, layer.units * 4 * layer.units, path), layer.units, 4 * layer.units, p);
+        layer.bias = read_values<float>(in, 4 * layer.units, path);
+        expect(n_in == width, path, "LSTM input does not match the features");
+        width = layer.units;
+        lstm = std::make_unique<lstm_layer>(std::move(layer));
+      } else if (word == "dense") {
+        std::size_t n_in = read_size(in, path);
+        std::size_t n_out = read_size(in, path);
+        dense_layer layer;
+        layer.act = read_activation(in, path);
+        layer.kernel = matrix(read_values<float>(in, n_in * n_out, path), n_in, n_out, p);
+        layer.bias = read_values<float>(in, n_out, path);
+        expect(n_in == width, path, "dense input does not match the layer before it");
+        width = n_out;
+        dense.push_back(std::move(layer));
+      } else {
+        throw std::runtime_error(path + ": unknown section " + word);
+      }
+    }
+    expect(word == "end", path, "missing end");
+    expect(!features.empty(), path, "no features");
+    expect(history == 1 || lstm, path, "a history needs an LSTM layer");
+    expect(history >= 1 && output < width, path, "output index out of range");
+  }
+
+  // Score of the most recent access, given the raw features of the last
+  // history accesses: row t of the sequence, oldest first, is
+  // rows[((oldest + t) % history) * features.size()], so a ring buffer can be
+  // passed as it is. Scaling is done in double, since addresses and cycles
+  // do not fit in a float.
+  float predict(const double* rows, std::size_t oldest)
+  {
+    const std::size_t n = features.size();
+    sequence.resize(history * n);
+    for (std::size_t t = 0; t < history; ++t) {
+      const double* row = rows + ((oldest + t) % history) * n;
+      for (std::size_t f = 0; f < n; ++f)
+        sequence[t * n + f] = static_cast<float>(offsets.empty() ? row[f] : (row[f] - offsets[f]) * factors[f]);
+    }
+
+    const float* x = sequence.data();
+    if (lstm) {
+      run_lstm(x);
+      x = h.data();
+    }
+    for (const auto& layer : dense) {
+      next.assign(layer.bias.begin(), layer.bias.end());
+      layer.kernel.multiply_add(x, next.data(), scratch, sums);
+      for (auto& v : next)
+        v = activate(layer.act, v);
+      std::swap(current, next);
+      x = current.data();
+    }
+    return x[output];
+  }
+
+  // Bytes of weights the model holds at its precision
+  std::size_t weight_bytes() const
+  {
+    std::size_t bytes = 0;
+    if (lstm)
+      bytes += lstm->kernel.bytes() + lstm->recurrent.bytes() + lstm->bias.size() * sizeof(float);
+    for (const auto& layer : dense)
+      bytes += layer.kernel.bytes() + layer.bias.size() * sizeof(float);
+    return bytes;
+  }
+
+private:
+  std::vector<double> offsets;
+  std::vector<double> factors;
+  std::unique_ptr<lstm_layer> lstm;
+  std::vector<dense_layer> dense;
+
+  // Working vectors, kept to avoid allocating per prediction
+  std::vector<float> sequence, h, c, gates, current, next;
+  std::vector<int8_t> scratch;
+  std::vector<int32_t> sums;
+
+  void run_lstm(const float* x)
+  {
+    const std::size_t u = lstm->units;
+    h.assign(u, 0);
+    c.assign(u, 0);
+    for (std::size_t t = 0; t < history; ++t) {
+      gates = lstm->bias;
+      lstm->kernel.multiply_add(x + t * features.size(), gates.data(), scratch, sums);
+      lstm->recurrent.multiply_add(h.data(), gates.data(), scratch, sums);
+      for (std::size_t j = 0; j < u; ++j) {
+        float i_gate = activate(activation::sigmoid, gates[j]);
+        float f_gate = activate(activation::sigmoid, gates[u + j]);
+        float candidate = activate(lstm->act, gates[2 * u + j]);
+        float o_gate = activate(activation::sigmoid, gates[3 * u + j]);
+        c[j] = f_gate * c[j] + i_gate * candidate;
+        h[j] = o_gate * activate(lstm->act, c[j]);
+      }
+    }
+  }
+
+  static void expect(bool condition, const std::string& path, const char* what)
+  {
+    if (!condition)
+      throw std::runtime_error(path + ": " + what);
+  }
+
+  static std::size_t read_size(std::istream& in, const std::string& path)
+  {
+    std::size_t n = 0;
+    if (!(in >> n))
+      throw std::runtime_error(path + ": expected a size");
+    return n;
+  }
+
+  template <typename T>
+  static std::vector<T> read_values(std::istream& in, std::size_t n, const std::string& path)
+  {
+    std::vector<T> values(n);
+    for (auto& v : values)
+      if (!(in >> v))
+        throw std::runtime_error(path + ": truncated weights");
+    return values;
+  }
+
+  static activation read_activation(std::istream& in, const std::string& path)
+  {
+    std::string name;
+    in >> name;
+    if (name == "linear")
+      return activation::linear;
+    if (name == "relu")
+      return activation::relu;
+    if (name == "sigmoid")
+      return activation::sigmoid;
+    if (name == "tanh")
+      return activation::tanh;
+    throw std::runtime_error(path + ": unknown activation " + name);
+  }
+};
+} // namespace mlpredict
+
+#endif
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "../policy.h"
+#include "../rrpv_search.h"
+#include "inference.h"
+
+// RRIP with the insertion priority of each fill chosen by one of the hit/miss
+// models trained in "LRU Predictive Model Code".
+//
+// MLPREDICT_MODEL (or MLPREDICT_MODEL_<cache name>) names the model, as
+// written by export_model.py; see inference.h for the format. Its features
+// are taken from each access: address, set, type (0 read, 1 writeback, as in
+// the lruStat CSVs), cycle, size (the block size), hit, and ip. Every access
+// goes into a history of the model's length; at a fill the model scores that
+// history, and a score at or above the model's threshold inserts the line at
+// maxRRPV - 1 instead of maxRRPV. Hits promote to 0 and writebacks are
+// inserted at maxRRPV without asking the model.
+//
+// Inference runs at fills only, and its result is reused for the next
+// MLPREDICT_REFRESH fills (default 64; 0 runs the model at every fill), so the
+// cost per access stays bounded however large the model is. A model that takes
+// ip as a feature (export_model.py --ip) is asked per PC: its predictions are
+// kept in a small direct-mapped cache indexed by PC, and a PC's next fills
+// reuse its last one. Any other model does not see the PC, so one prediction
+// is shared by every fill until it is refreshed. MLPREDICT_PRECISION is fp32
+// (default) or int8.
+//
+// The models see raw simulator values through the scaler fitted on their
+// training data, so they only predict well for workloads like that data;
+// export the model from a capture of the workload being simulated.
+
+namespace
+{
+constexpr uint8_t maxRRPV = 3;
+constexpr std::size_t PREDICTION_CACHE_SIZE = 4096;
+
+enum class feature { address, set, type, cycle, size, hit, ip };
+
+feature parse_feature(const std::string& name)
+{
+  static const std::pair<const char*, feature> names[] = {{"address", feature::address}, {"set", feature::set},   {"type", feature::type}, {"cycle", feature::cycle},
+                                                          {"size", feature::size},       {"hit", feature::hit},   {"ip", feature::ip}};
+  for (const auto& [known, f] : names)
+    if (name == known)
+      return f;
+  throw std::invalid_argument("mlPredict: the model uses feature " + name + ", which the policy does not provide");
+}
+
+struct cached_prediction {
+  uint64_t ip = 0;
+  bool valid = false;
+  bool friendly = false;
+  uint32_t uses = 0;
+};
+
+class ml_predict : public replacement::policy
+{
+  std::unique_ptr<mlpredict::model> model;
+  std::vector<feature> features;
+
+  // The last history accesses, one row of features each, as a ring
+  std::vector<double> ring;
+  std::size_t oldest = 0;
+  uint64_t seen = 0;
+
+  std::vector<uint8_t> rrpv_values;
+  std::vector<cached_prediction> predictions; // per PC if the model takes ip, otherwise one
+  uint32_t refresh = 64;
+  bool per_pc = false;
+
+  uint64_t fills = 0;
+  uint64_t inferences = 0;
+  uint64_t cached = 0;
+  uint64_t friendly_fills = 0;
+
+  void record(uint32_t set, uint64_t full_addr, uint64_t ip, uint32_t type, uint8_t hit);
+  bool predict(uint64_t ip);
+
+public:
+  using policy::policy;
+
+  void initialize_replacement() override;
+  uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) override;
+  void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                uint8_t hit) override;
+  void replacement_final_stats() override;
+};
+} // namespace
+
+void ml_predict::initialize_replacement()
+{
+  const char* path = setting("MLPREDICT_MODEL");
+  if (path == nullptr)
+    throw std::invalid_argument(NAME + " mlPredict needs a model; set MLPREDICT_MODEL or MLPREDICT_MODEL_" + NAME);
+
+  auto precision = mlpredict::precision::fp32;
+  if (const char* value = setting("MLPREDICT_PRECISION")) {
+    std::string name = value;
+    if (name == "int8")
+      precision = mlpredict::precision::int8;
+    else if (name != "fp32")
+      throw std::invalid_argument("MLPREDICT_PRECISION must be fp32 or int8, not " + name);
+  }
+  if (const char* value = setting("MLPREDICT_REFRESH")) {
+    std::string text = value;
+    unsigned long long fills = 0;
+    try {
+      if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        throw std::invalid_argument(text);
+      fills = std::stoull(text);
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument("MLPREDICT_REFRESH must be a number, not " + text);
+    }
+    if (fills > std::numeric_limits<uint32_t>::max())
+      throw std::invalid_argument("MLPREDICT_REFRESH must be at most " + std::to_string(std::numeric_limits<uint32_t>::max()));
+    refresh = static_cast<uint32_t>(fills);
+  }
+
+  model = std::make_unique<mlpredict::model>(path, precision);
+  std::transform(model->features.begin(), model->features.end(), std::back_inserter(features), parse_feature);
+  ring.assign(model->history * features.size(), 0);
+  rrpv_values.assign(NUM_SET * NUM_WAY, maxRRPV);
+  per_pc = std::find(features.begin(), features.end(), feature::ip) != features.end();
+  predictions.assign(per_pc ? PREDICTION_CACHE_SIZE : 1, {});
+
+  std::cout << NAME << " mlPredict: " << path << ", " << features.size() << " features x " << model->history << " accesses, "
+            << (precision == mlpredict::precision::int8 ? "int8" : "fp32") << " weights in " << model->weight_bytes() << " bytes, predictions reused for " << refresh
+            << (per_pc ? " fills per PC" : " fills") << std::endl;
+}
+
+void ml_predict::record(uint32_t set, uint64_t full_addr, uint64_t ip, uint32_t type, uint8_t hit)
+{
+  double* row = &ring[oldest * features.size()];
+  for (std::size_t f = 0; f < features.size(); ++f) {
+    switch (features[f]) {
+    case feature::address:
+      row[f] = static_cast<double>(full_addr);
+      break;
+    case feature::set:
+      row[f] = set;
+      break;
+    case feature::type:
+      row[f] = access_type{type} == access_type::WRITE;
+      break;
+    case feature::cycle:
+      row[f] = static_cast<double>(current_cycle);
+      break;
+    case feature::size:
+      row[f] = BLOCK_SIZE;
+      break;
+    case feature::hit:
+      row[f] = hit;
+      break;
+    case feature::ip:
+      row[f] = static_cast<double>(ip);
+      break;
+    }
+  }
+  oldest = (oldest + 1) % model->history;
+  ++seen;
+}
+
+// Whether a fill by ip should be kept longer, from the prediction cache or the
+// model. A model without ip has a single entry, which every PC shares.
+bool ml_predict::predict(uint64_t ip)
+{
+  if (!per_pc)
+    ip = 0;
+  auto& entry = predictions[(ip ^ (ip >> 12)) % predictions.size()];
+  if (entry.valid && entry.ip == ip && entry.uses < refresh) {
+    ++entry.uses;
+    ++cached;
+    return entry.friendly;
+  }
+
+  ++inferences;
+  entry.ip = ip;
+  entry.valid = true;
+  entry.uses = 0;
+  entry.friendly = model->predict(ring.data(), oldest) >= model->threshold;
+  return entry.friendly;
+}
+
+uint32_t ml_predict::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
+{
+  auto set_rrpv = std::next(std::data(rrpv_values), set * NUM_WAY);
+  return rrpv::find_victim_and_age(set_rrpv, NUM_WAY, maxRRPV);
+}
+
+void ml_predict::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                          uint8_t hit)
+{
+  record(set, full_addr, ip, type, hit);
+  if (way >= NUM_WAY)
+    return;
+
+  uint8_t& rrpv = rrpv_values[set * NUM_WAY + way];
+  if (hit) {
+    rrpv = 0;
+    return;
+  }
+
+  rrpv = maxRRPV;
+  if (access_type{type} == access_type::WRITE)
+    return;
+
+  // Until the history is full, insert as SRRIP would
+  ++fills;
+  bool friendly = seen < model->history || predict(ip);
+  friendly_fills += friendly;
+  if (friendly)
+    rrpv = maxRRPV - 1;
+}
+
+void ml_predict::replacement_final_stats()
+{
+  std::cout << NAME << " mlPredict: " << fills << " fills, " << inferences << " inferences, " << cached << " from the prediction cache, "
+            << friendly_fills << " inserted at " << (maxRRPV - 1) << std::endl;
+}
+
+REPLACEMENT_LEGACY_HOOKS(ml_predict, )
@@ -1,48 +1,29 @@
 #include "cache.h"
 #include "ooo_cpu.h"
-#include <unordered_map>
+#include "msl/bits.h"
+#include "../policy.h"
+#include "../signature_hash.h"
 #include <cmath> // for std::log2
 #include <algorithm>
+#include <memory>
+#include <vector>
 #include <stdlib.h>
 using namespace std;
 
 
-#ifndef LLC_SET
-#define LLC_SET 1024  // Number of sets in LLC
-#endif
-
-#ifndef LLC_WAY
-#define LLC_WAY 16  // Number of ways in LLC
-#endif
-
-
-constexpr int LOG2_LLC_SET = log2(LLC_SET);
-constexpr int LOG2_LLC_SIZE = LOG2_LLC_SET + log2(LLC_WAY) + LOG2_BLOCK_SIZE;
-constexpr int LOG2_SAMPLED_SETS = LOG2_LLC_SIZE - 16;
+namespace {
 
 constexpr int HISTORY = 8;
 constexpr int GRANULARITY = 8;
 
-constexpr int INF_RD = LLC_WAY * HISTORY - 1;
-constexpr int INF_ETR = (LLC_WAY * HISTORY / GRANULARITY) - 1;
-constexpr int MAX_RD = INF_RD - 22;
-
 constexpr int SAMPLED_CACHE_WAYS = 5;
 constexpr int LOG2_SAMPLED_CACHE_SETS = 4;
-constexpr int SAMPLED_CACHE_TAG_BITS = 31 - LOG2_LLC_SIZE;
-constexpr int PC_SIGNATURE_BITS = LOG2_LLC_SIZE - 10;
 constexpr int TIMESTAMP_BITS = 8;
 
 constexpr double TEMP_DIFFERENCE = 1.0/16.0;
 constexpr double FLEXMIN_PENALTY = 2.0 - log2(NUM_CPUS)/4.0;
 
-
-int etr[LLC_SET][LLC_WAY];
-int etr_clock[LLC_SET];
-
-unordered_map<uint32_t, int> rdp;
-
-int current_timestamp[LLC_SET];
+constexpr int16_t RDP_INVALID = -1;
 
 struct SampledCacheLine {
     bool valid;
@@ -50,114 +31,200 @@ struct SampledCacheLine {
     uint64_t signature;
     int timestamp;
 };
-unordered_map<uint32_t, SampledCacheLine* > sampled_cache;
-
-
-bool is_sampled_set(int set) {
-    int mask_length = LOG2_LLC_SET-LOG2_SAMPLED_SETS;
-    int mask = (1 << mask_length) - 1;
-    return (set & mask) == ((set >> (LOG2_LLC_SET - mask_length)) & mask);
-}
 
 uint64_t CRC_HASH( uint64_t _blockAddress )
 {
-    static const unsigned long long crcPolynomial = 3988292384ULL;
-    unsigned long long _returnVal = _blockAddress;
-    for( unsigned int i = 0; i < 3; i++)
-        _returnVal = ( ( _returnVal & 1 ) == 1 ) ? ( ( _returnVal >> 1 ) ^ crcPolynomial ) : ( _returnVal >> 1 );
-    return _returnVal;
+    return signature_hash::hash<3>(_blockAddress);
 }
 
-uint64_t get_pc_signature(uint64_t pc, bool hit, bool prefetch, uint32_t core) {
-    if (NUM_CPUS == 1) {
-        pc = pc << 1;
-        if(hit) {
-            pc = pc | 1;
-        }
-        pc = pc << 1;
-        if (prefetch) {
-            pc = pc | 1;                            
-        }
-        pc = CRC_HASH(pc);
-        pc = (pc << (64 - PC_SIGNATURE_BITS)) >> (64 - PC_SIGNATURE_BITS);
-    } else {
-        pc = pc << 1;
-        if(prefetch) {
-            pc = pc | 1;
-        }
-        pc = pc << 2;
-        pc = pc | core;
-        pc = CRC_HASH(pc);
-        pc = (pc << (64 - PC_SIGNATURE_BITS)) >> (64 - PC_SIGNATURE_BITS);
-    }
-    return pc;
+int increment_timestamp(int input) {
+    input++;
+    input = input % (1 << TIMESTAMP_BITS);
+    return input;
 }
 
-uint32_t get_sampled_cache_index(uint64_t full_addr) {
-    full_addr = full_addr >> LOG2_BLOCK_SIZE;
-    full_addr = (full_addr << (64 - (LOG2_SAMPLED_CACHE_SETS + LOG2_LLC_SET))) >> (64 - (LOG2_SAMPLED_CACHE_SETS + LOG2_LLC_SET));
-    return full_addr;
+int time_elapsed(int global, int local) {
+    if (global >= local) {
+        return global - local;
+    }
+    global = global + (1 << TIMESTAMP_BITS);
+    return global - local;
 }
 
-uint64_t get_sampled_cache_tag(uint64_t x) {
-    x >>= LOG2_LLC_SET + LOG2_BLOCK_SIZE + LOG2_SAMPLED_CACHE_SETS;
-    x = (x << (64 - SAMPLED_CACHE_TAG_BITS)) >> (64 - SAMPLED_CACHE_TAG_BITS);
-    return x;
-}
+/* Mockingjay state for one cache. The parameters that used to come from the
+ * LLC_SET/LLC_WAY macros are derived from the cache's own geometry, so each
+ * cache instance gets correctly sized tables. */
+struct mockingjay_state {
+    const int LLC_SET;
+    const int LLC_WAY;
+    const int LOG2_LLC_SET;
+    const int LOG2_LLC_SIZE;
+    // at least two sampled sets, so the mask test in is_sampled_set stays meaningful on small caches
+    const int LOG2_SAMPLED_SETS;
+
+    const int INF_RD;
+    const int INF_ETR;
+    const int MAX_RD;
+
+    const int SAMPLED_CACHE_TAG_BITS;
+    const int PC_SIGNATURE_BITS;
+
+    vector<int> etr; // LLC_SET x LLC_WAY
+    vector<int> etr_clock;
+    vector<int> current_timestamp;
+
+    // Reuse distance predictor, indexed directly by PC signature. An entry is
+    // RDP_INVALID until its signature is first trained.
+    vector<int16_t> rdp;
+
+    // Sampled sets are the ones whose low and high LOG2_LLC_SET-LOG2_SAMPLED_SETS
+    // bits match, so the low LOG2_SAMPLED_SETS bits tell them apart. Each sampled
+    // set owns 2^LOG2_SAMPLED_CACHE_SETS rows of SAMPLED_CACHE_WAYS lines, all kept
+    // in one array that is released in replacement_final_stats().
+    unique_ptr<SampledCacheLine[]> sampled_cache;
+
+    mockingjay_state(uint32_t num_set, uint32_t num_way)
+        : LLC_SET(num_set), LLC_WAY(num_way), LOG2_LLC_SET(champsim::lg2(num_set)),
+          LOG2_LLC_SIZE(LOG2_LLC_SET + champsim::lg2(num_way) + LOG2_BLOCK_SIZE),
+          LOG2_SAMPLED_SETS(max(LOG2_LLC_SIZE - 16, 1)),
+          INF_RD(LLC_WAY * HISTORY - 1), INF_ETR((LLC_WAY * HISTORY / GRANULARITY) - 1), MAX_RD(INF_RD - 22),
+          SAMPLED_CACHE_TAG_BITS(31 - LOG2_LLC_SIZE), PC_SIGNATURE_BITS(LOG2_LLC_SIZE - 10),
+          etr(num_set * num_way, 0), etr_clock(num_set, GRANULARITY), current_timestamp(num_set, 0),
+          rdp(1 << PC_SIGNATURE_BITS, RDP_INVALID),
+          sampled_cache(new SampledCacheLine[sampled_cache_lines()]())
+    {
+    }
 
-int search_sampled_cache(uint64_t blockAddress, uint32_t set) {
-    SampledCacheLine* sampled_set = sampled_cache[set];
-    for (int way = 0; way < SAMPLED_CACHE_WAYS; way++) {
-        if (sampled_set[way].valid && (sampled_set[way].tag == blockAddress)) {
-            return way;
-        }
+    size_t sampled_cache_lines() const { return ((1 << LOG2_SAMPLED_SETS) << LOG2_SAMPLED_CACHE_SETS) * SAMPLED_CACHE_WAYS; }
+
+    void serialize_state(replacement::checkpoint::archive& ar) {
+        ar(etr, etr_clock, current_timestamp, rdp);
+        ar.expect(sampled_cache_lines(), "sampled cache size");
+        ar.array(sampled_cache.get(), sampled_cache_lines());
     }
-    return -1;
-}
 
-void detrain(uint32_t set, int way) {
-    SampledCacheLine temp = sampled_cache[set][way];
-    if (!temp.valid) {
-        return;
+    int* etr_set(uint32_t set) { return &etr[set * LLC_WAY]; }
+
+    // index is get_sampled_cache_index(): the LLC set in the low bits, the row above it
+    SampledCacheLine* get_sampled_row(uint32_t index) {
+        uint32_t set = index & (LLC_SET - 1);
+        uint32_t row = index >> LOG2_LLC_SET;
+        uint32_t sampled_set = set & ((1 << LOG2_SAMPLED_SETS) - 1);
+        return &sampled_cache[((sampled_set << LOG2_SAMPLED_CACHE_SETS) | row) * SAMPLED_CACHE_WAYS];
     }
 
-    if (rdp.count(temp.signature)) {
-        rdp[temp.signature] = min(rdp[temp.signature] + 1, INF_RD);
-    } else {
-        rdp[temp.signature] = INF_RD;
+    bool is_sampled_set(int set) {
+        int mask_length = LOG2_LLC_SET-LOG2_SAMPLED_SETS;
+        int mask = (1 << mask_length) - 1;
+        return (set & mask) == ((set >> (LOG2_LLC_SET - mask_length)) & mask);
     }
-    sampled_cache[set][way].valid = false;
-}
 
+    uint64_t get_pc_signature(uint64_t pc, bool hit, bool prefetch, uint32_t core) {
+        if (NUM_CPUS == 1) {
+            pc = pc << 1;
+            if(hit) {
+                pc = pc | 1;
+            }
+            pc = pc << 1;
+            if (prefetch) {
+                pc = pc | 1;
+            }
+            pc = CRC_HASH(pc);
+            pc = (pc << (64 - PC_SIGNATURE_BITS)) >> (64 - PC_SIGNATURE_BITS);
+        } else {
+            pc = pc << 1;
+            if(prefetch) {
+                pc = pc | 1;
+            }
+            pc = pc << 2;
+            pc = pc | core;
+            pc = CRC_HASH(pc);
+            pc = (pc << (64 - PC_SIGNATURE_BITS)) >> (64 - PC_SIGNATURE_BITS);
+        }
+        return pc;
+    }
 
-/* initialize cache replacement state */
-void CACHE::initialize_replacement()
-{
-    // put your own initialization code here
-    for(int i = 0; i < LLC_SET; i++) {
-        etr_clock[i] = GRANULARITY;
-        current_timestamp[i] = 0;
+    uint32_t get_sampled_cache_index(uint64_t full_addr) {
+        full_addr = full_addr >> LOG2_BLOCK_SIZE;
+        full_addr = (full_addr << (64 - (LOG2_SAMPLED_CACHE_SETS + LOG2_LLC_SET))) >> (64 - (LOG2_SAMPLED_CACHE_SETS + LOG2_LLC_SET));
+        return full_addr;
     }
-    for(uint32_t set = 0; set < LLC_SET; set++) {
-        if (is_sampled_set(set)) {
-            int modifier = 1 << LOG2_LLC_SET;
-            int limit = 1 << LOG2_SAMPLED_CACHE_SETS;
-            for (int i = 0; i < limit; i++) {
-                sampled_cache[set + modifier*i] = new SampledCacheLine[SAMPLED_CACHE_WAYS]();
+
+    uint64_t get_sampled_cache_tag(uint64_t x) {
+        x >>= LOG2_LLC_SET + LOG2_BLOCK_SIZE + LOG2_SAMPLED_CACHE_SETS;
+        x = (x << (64 - SAMPLED_CACHE_TAG_BITS)) >> (64 - SAMPLED_CACHE_TAG_BITS);
+        return x;
+    }
+
+    int search_sampled_cache(uint64_t blockAddress, uint32_t set) {
+        SampledCacheLine* sampled_set = get_sampled_row(set);
+        for (int way = 0; way < SAMPLED_CACHE_WAYS; way++) {
+            if (sampled_set[way].valid && (sampled_set[way].tag == blockAddress)) {
+                return way;
             }
         }
+        return -1;
     }
-}
+
+    void detrain(uint32_t set, int way) {
+        SampledCacheLine& temp = get_sampled_row(set)[way];
+        if (!temp.valid) {
+            return;
+        }
+
+        int16_t& rd = rdp[temp.signature];
+        if (rd != RDP_INVALID) {
+            rd = min(rd + 1, INF_RD);
+        } else {
+            rd = INF_RD;
+        }
+        temp.valid = false;
+    }
+
+    int temporal_difference(int init, int sample) {
+        if (sample > init) {
+            int diff = sample - init;
+            diff = diff * TEMP_DIFFERENCE;
+            diff = min(1, diff);
+            return min(init + diff, INF_RD);
+        } else if (sample < init) {
+            int diff = init - sample;
+            diff = diff * TEMP_DIFFERENCE;
+            diff = min(1, diff);
+            return max(init - diff, 0);
+        } else {
+            return init;
+        }
+    }
+};
+
+class mockingjay : public replacement::policy {
+    mockingjay_state mj;
+
+public:
+    explicit mockingjay(CACHE* cache) : policy(cache), mj(NUM_SET, NUM_WAY) {}
+
+    uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t pc, uint64_t full_addr, uint32_t type) override;
+    void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t pc, uint64_t victim_addr, uint32_t type, uint8_t hit) override;
+    bool serialize_state(replacement::checkpoint::archive& ar) override {
+        ar(mj);
+        return true;
+    }
+    void replacement_final_stats() override;
+};
+
+} // namespace
 
 
 /* find a cache block to evict
- * return value should be 0 ~ 15 (corresponds to # of ways in cache) 
- * current_set: an array of BLOCK, of size 16 */
-uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t pc, uint64_t full_addr, uint32_t type)
+ * return value should be 0 ~ NUM_WAY-1 (corresponds to # of ways in cache),
+ * or NUM_WAY to bypass
+ * current_set: an array of BLOCK, of size NUM_WAY */
+uint32_t mockingjay::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK *current_set, uint64_t pc, uint64_t full_addr, uint32_t type)
 {
     /* don't modify this code or put anything above it;
      * if there's an invalid block, we don't need to evict any valid ones */
-    for (int way = 0; way < LLC_WAY; way++) {
+    for (int way = 0; way < mj.LLC_WAY; way++) {
         if (current_set[way].valid == false) {
             return way;
         }
@@ -165,94 +232,68 @@ uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t
 
 
     // your eviction policy goes here
+    int* etr = mj.etr_set(set);
     int max_etr = 0;
     int victim_way = 0;
-    for (int way = 0; way < LLC_WAY; way++) {
-        if (abs(etr[set][way]) > max_etr ||
-                (abs(etr[set][way]) == max_etr &&
-                        etr[set][way] < 0)) {
-            max_etr = abs(etr[set][way]);
+    for (int way = 0; way < mj.LLC_WAY; way++) {
+        if (abs(etr[way]) > max_etr ||
+                (abs(etr[way]) == max_etr &&
+                        etr[way] < 0)) {
+            max_etr = abs(etr[way]);
             victim_way = way;
         }
     }
-    
-    uint64_t pc_signature = get_pc_signature(pc, false, access_type{type} == access_type::PREFETCH, triggering_cpu);
-    if (access_type{type} != access_type::WRITE && rdp.count(pc_signature) &&
-            (rdp[pc_signature] > MAX_RD || rdp[pc_signature] / GRANULARITY > max_etr)) {
-        return LLC_WAY;
-    }
-    
-    return victim_way;
-}
-
 
-int temporal_difference(int init, int sample) {
-    if (sample > init) {
-        int diff = sample - init;
-        diff = diff * TEMP_DIFFERENCE;
-        diff = min(1, diff);
-        return min(init + diff, INF_RD);
-    } else if (sample < init) {
-        int diff = init - sample;
-        diff = diff * TEMP_DIFFERENCE;
-        diff = min(1, diff);
-        return max(init - diff, 0);
-    } else {
-        return init;
+    uint64_t pc_signature = mj.get_pc_signature(pc, false, access_type{type} == access_type::PREFETCH, triggering_cpu);
+    int rd = mj.rdp[pc_signature];
+    if (access_type{type} != access_type::WRITE && rd != RDP_INVALID &&
+            (rd > mj.MAX_RD || rd / GRANULARITY > max_etr)) {
+        return mj.LLC_WAY;
     }
-}
 
-int increment_timestamp(int input) {
-    input++;
-    input = input % (1 << TIMESTAMP_BITS);
-    return input;
-}
-
-int time_elapsed(int global, int local) {
-    if (global >= local) {
-        return global - local;
-    }
-    global = global + (1 << TIMESTAMP_BITS);
-    return global - local;
+    return victim_way;
 }
 
 
 /* called on every cache hit and cache fill */
-void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t pc, uint64_t victim_addr, uint32_t type, uint8_t hit)
+void mockingjay::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t pc, uint64_t victim_addr, uint32_t type, uint8_t hit)
 {
+    int* etr = mj.etr_set(set);
+
     if (access_type{type} == access_type::WRITE) {
         if(!hit) {
-            etr[set][way] = -INF_ETR;
+            etr[way] = -mj.INF_ETR;
         }
         return;
     }
-        
 
-    pc = get_pc_signature(pc, hit, access_type{type} == access_type::PREFETCH, triggering_cpu);
+
+    pc = mj.get_pc_signature(pc, hit, access_type{type} == access_type::PREFETCH, triggering_cpu);
 
 
-    if (is_sampled_set(set)) {
-        uint32_t sampled_cache_index = get_sampled_cache_index(full_addr);
-        uint64_t sampled_cache_tag = get_sampled_cache_tag(full_addr);
-        int sampled_cache_way = search_sampled_cache(sampled_cache_tag, sampled_cache_index);
+    if (mj.is_sampled_set(set)) {
+        uint32_t sampled_cache_index = mj.get_sampled_cache_index(full_addr);
+        uint64_t sampled_cache_tag = mj.get_sampled_cache_tag(full_addr);
+        int sampled_cache_way = mj.search_sampled_cache(sampled_cache_tag, sampled_cache_index);
+        SampledCacheLine* sampled_row = mj.get_sampled_row(sampled_cache_index);
 
         if (sampled_cache_way > -1) {
-            uint64_t last_signature = sampled_cache[sampled_cache_index][sampled_cache_way].signature;
-            uint64_t last_timestamp = sampled_cache[sampled_cache_index][sampled_cache_way].timestamp;
-            int sample = time_elapsed(current_timestamp[set], last_timestamp);
+            uint64_t last_signature = sampled_row[sampled_cache_way].signature;
+            uint64_t last_timestamp = sampled_row[sampled_cache_way].timestamp;
+            int sample = time_elapsed(mj.current_timestamp[set], last_timestamp);
 
-            if (sample <= INF_RD) {
+            if (sample <= mj.INF_RD) {
                 if (access_type{type} == access_type::PREFETCH) {
                     sample = sample * FLEXMIN_PENALTY;
                 }
-                if (rdp.count(last_signature)) {
-                    int init = rdp[last_signature];
-                    rdp[last_signature] = temporal_difference(init, sample);
+                int16_t& rd = mj.rdp[last_signature];
+                if (rd != RDP_INVALID) {
+                    rd = mj.temporal_difference(rd, sample);
                 } else {
-                    rdp[last_signature] = sample;
+                    rd = sample;
                 }
 
-                sampled_cache[sampled_cache_index][sampled_cache_way].valid = false;
+                sampled_row[sampled_cache_way].valid = false;
             }
         }
 
@@ -260,61 +301,62 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
         int lru_way = -1;
         int lru_rd = -1;
         for (int w = 0; w < SAMPLED_CACHE_WAYS; w++) {
-            if (sampled_cache[sampled_cache_index][w].valid == false) {
+            if (sampled_row[w].valid == false) {
                 lru_way = w;
-                lru_rd = INF_RD + 1;
+                lru_rd = mj.INF_RD + 1;
                 continue;
             }
 
-            uint64_t last_timestamp = sampled_cache[sampled_cache_index][w].timestamp;
-            int sample = time_elapsed(current_timestamp[set], last_timestamp);
-            if (sample > INF_RD) {
+            uint64_t last_timestamp = sampled_row[w].timestamp;
+            int sample = time_elapsed(mj.current_timestamp[set], last_timestamp);
+            if (sample > mj.INF_RD) {
                 lru_way = w;
-                lru_rd = INF_RD + 1;
-                detrain(sampled_cache_index, w);
+                lru_rd = mj.INF_RD + 1;
+                mj.detrain(sampled_cache_index, w);
             } else if (sample > lru_rd) {
                 lru_way = w;
                 lru_rd = sample;
             }
         }
-        detrain(sampled_cache_index, lru_way);
+        mj.detrain(sampled_cache_index, lru_way);
 
         for (int w = 0; w < SAMPLED_CACHE_WAYS; w++) {
-            if (sampled_cache[sampled_cache_index][w].valid == false) {
-                sampled_cache[sampled_cache_index][w].valid = true;
-                sampled_cache[sampled_cache_index][w].signature = pc;
-                sampled_cache[sampled_cache_index][w].tag = sampled_cache_tag;
-                sampled_cache[sampled_cache_index][w].timestamp = current_timestamp[set];
+            if (sampled_row[w].valid == false) {
+                sampled_row[w].valid = true;
+                sampled_row[w].signature = pc;
+                sampled_row[w].tag = sampled_cache_tag;
+                sampled_row[w].timestamp = mj.current_timestamp[set];
                 break;
             }
         }
-        
-        current_timestamp[set] = increment_timestamp(current_timestamp[set]);
+
+        mj.current_timestamp[set] = increment_timestamp(mj.current_timestamp[set]);
     }
 
-    if(etr_clock[set] == GRANULARITY) {
-        for (int w = 0; w < LLC_WAY; w++) {
-            if ((uint32_t) w != way && abs(etr[set][w]) < INF_ETR) {
-                etr[set][w]--;
+    if(mj.etr_clock[set] == GRANULARITY) {
+        for (int w = 0; w < mj.LLC_WAY; w++) {
+            if ((uint32_t) w != way && abs(etr[w]) < mj.INF_ETR) {
+                etr[w]--;
             }
         }
-        etr_clock[set] = 0;
+        mj.etr_clock[set] = 0;
     }
-    etr_clock[set]++;
-    
-    
-    if (way < LLC_WAY) {
-        if(!rdp.count(pc)) {
+    mj.etr_clock[set]++;
+
+
+    if (way < (uint32_t) mj.LLC_WAY) {
+        int rd = mj.rdp[pc];
+        if(rd == RDP_INVALID) {
             if (NUM_CPUS == 1) {
-                etr[set][way] = 0;
+                etr[way] = 0;
             } else {
-                etr[set][way] = INF_ETR;
+                etr[way] = mj.INF_ETR;
             }
         } else {
-            if(rdp[pc] > MAX_RD) {
-                etr[set][way] = INF_ETR;
+            if(rd > mj.MAX_RD) {
+                etr[way] = mj.INF_ETR;
             } else {
-                etr[set][way] = rdp[pc] / GRANULARITY;
+                etr[way] = rd / GRANULARITY;
             }
         }
     }
@@ -322,6 +364,9 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 
 
 /* called at the end of the simulation */
-void CACHE::replacement_final_stats()
+void mockingjay::replacement_final_stats()
 {
-}
\ No newline at end of file
+    mj.sampled_cache.reset();
+}
+
+REPLACEMENT_LEGACY_HOOKS(mockingjay, )
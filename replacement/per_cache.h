@@ -0,0 +1,60 @@
+#ifndef REPLACEMENT_PER_CACHE_H
+#define REPLACEMENT_PER_CACHE_H
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class CACHE;
+
+namespace replacement
+{
+// Replacement state owned by one cache instance.
+//
+// The state is created once in initialize_replacement() and then looked up from
+// the CACHE pointer on every access. A one-entry memo in front of the lookup
+// means the usual case (a single cache using the policy) is a pointer compare
+// instead of a tree walk; other caches fall back to a short linear scan.
+template <typename T>
+class per_cache
+{
+  std::vector<std::pair<const CACHE*, std::unique_ptr<T>>> entries;
+  const CACHE* last_key = nullptr;
+  T* last_value = nullptr;
+
+public:
+  template <typename... Args>
+  T& emplace(const CACHE* key, Args&&... args)
+  {
+    return insert(key, std::make_unique<T>(std::forward<Args>(args)...));
+  }
+
+  // Take ownership of already-built state, e.g. an object derived from T
+  T& insert(const CACHE* key, std::unique_ptr<T> value)
+  {
+    auto found = std::find_if(std::begin(entries), std::end(entries), [key](const auto& x) { return x.first == key; });
+    if (found == std::end(entries))
+      found = entries.insert(std::end(entries), {key, nullptr});
+
+    found->second = std::move(value);
+    last_key = key;
+    last_value = found->second.get();
+    return *last_value;
+  }
+
+  T& operator[](const CACHE* key)
+  {
+    if (key != last_key) {
+      auto found = std::find_if(std::begin(entries), std::end(entries), [key](const auto& x) { return x.first == key; });
+      assert(found != std::end(entries)); // state must be created in initialize_replacement()
+      last_key = key;
+      last_value = found->second.get();
+    }
+    return *last_value;
+  }
+};
+} // namespace replacement
+
+#endif
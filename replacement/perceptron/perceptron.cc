@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "cache.h"
+#include "msl/bits.h"
+#include "../rrpv_search.h"
+#include "../policy.h"
+#include "../ship_state.h"
+
+// Perceptron reuse prediction: RRIP whose insertion priority comes from a sum
+// of small signed weights, one from each of several tables indexed by a
+// different hashed feature of the access, instead of from one counter per IP.
+// Features that alias in one table rarely alias in all of them, and features
+// other than the IP capture reuse that depends on where in the program and
+// the address space an access comes from.
+//
+// The features are the IP, the IP with the previous IP of the same core, the
+// IP with the two before that, the page, the IP with the block's offset in
+// its page, the IP with the page, the IP with the core, and the IP with the
+// prefetch bit. A sum above DEAD_THRESHOLD predicts that the line will not
+// be reused, and it is inserted at maxRRPV; otherwise at maxRRPV - 1.
+//
+// Training is online, in a sampler over a few sets (the SHiP sampler, with
+// its own associativity and partial tags): each sampled access remembers its
+// table indices and its sum. When the block is accessed again while in the
+// sampler its weights are moved towards reuse; when it falls out of the
+// sampler unreused, towards no reuse. Either only if the sum was wrong or
+// not confident (within THETA).
+//
+// The predictor and sampler storage is fixed at compile time, checked against
+// STORAGE_BUDGET_KIB per core, and reported with the final stats.
+
+namespace
+{
+constexpr uint8_t maxRRPV = 3;
+
+constexpr std::size_t NUM_FEATURES = 8;
+constexpr unsigned INDEX_BITS = 9;
+constexpr std::size_t TABLE_SIZE = std::size_t{1} << INDEX_BITS;
+constexpr int WEIGHT_BITS = 6;
+constexpr int WEIGHT_MAX = (1 << (WEIGHT_BITS - 1)) - 1;
+constexpr int WEIGHT_MIN = -(1 << (WEIGHT_BITS - 1));
+
+constexpr int THETA = 40;          // training threshold
+constexpr int DEAD_THRESHOLD = 20; // sum above this: insert at maxRRPV
+
+constexpr std::size_t SAMPLER_SETS_PER_CPU = 64;
+constexpr std::size_t SAMPLER_WAYS = 16;
+constexpr unsigned TAG_BITS = 16;
+constexpr unsigned SUM_BITS = 9; // holds any sum of NUM_FEATURES weights
+static_assert(NUM_FEATURES * (WEIGHT_MAX - WEIGHT_MIN) < (1 << SUM_BITS), "SUM_BITS is too small");
+
+// Bits of state: the weight tables, then per sampler entry its tag, table
+// indices, sum, valid bit and LRU position
+constexpr std::size_t TABLE_BITS = NUM_FEATURES * TABLE_SIZE * WEIGHT_BITS;
+constexpr std::size_t SAMPLE_BITS = TAG_BITS + NUM_FEATURES * INDEX_BITS + SUM_BITS + 1 + champsim::lg2(SAMPLER_WAYS);
+constexpr std::size_t SAMPLER_BITS = SAMPLER_SETS_PER_CPU * NUM_CPUS * SAMPLER_WAYS * SAMPLE_BITS;
+constexpr std::size_t STORAGE_BUDGET_KIB = 20;
+static_assert(TABLE_BITS + SAMPLER_BITS <= STORAGE_BUDGET_KIB * NUM_CPUS * 8 * 1024, "the perceptron predictor is over its storage budget");
+
+using feature_indices = std::array<uint16_t, NUM_FEATURES>;
+
+// A sampled access: the tag of its block in address (TAG_BITS of it), and
+// the indices and sum it was predicted with
+struct sample : ship::SAMPLER_class {
+  feature_indices indices{};
+  int16_t yout = 0;
+};
+
+// Sum of the weights at one index per table. The weights are in one flat
+// array, table after table, padded so that 4-byte gathers stay inside it.
+inline int sum_weights(const int8_t* weights, const feature_indices& indices)
+{
+  static_assert(NUM_FEATURES == 8, "the AVX2 sum gathers one weight per lane");
+#if defined(__AVX2__)
+  const __m256i offsets = _mm256_setr_epi32(0, TABLE_SIZE, 2 * TABLE_SIZE, 3 * TABLE_SIZE, 4 * TABLE_SIZE, 5 * TABLE_SIZE, 6 * TABLE_SIZE, 7 * TABLE_SIZE);
+  __m256i index = _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices.data()))), offsets);
+  __m256i gathered = _mm256_i32gather_epi32(reinterpret_cast<const int*>(weights), index, 1);
+  __m256i w = _mm256_srai_epi32(_mm256_slli_epi32(gathered, 24), 24); // sign-extend the low byte
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+#else
+  int sum = 0;
+  for (std::size_t f = 0; f < NUM_FEATURES; ++f)
+    sum += weights[f * TABLE_SIZE + indices[f]];
+  return sum;
+#endif
+}
+
+class perceptron : public replacement::policy
+{
+  ship::state<sample> st;
+  std::vector<int8_t> weights = std::vector<int8_t>(NUM_FEATURES * TABLE_SIZE + 3);
+  std::vector<std::array<uint64_t, 3>> ip_history = std::vector<std::array<uint64_t, 3>>(NUM_CPUS); // per core, newest first
+  uint64_t sampler_clock = 0;
+
+  uint64_t predictions = 0;
+  uint64_t predicted_dead = 0;
+  uint64_t trained = 0;
+
+  feature_indices hash_features(uint32_t cpu, uint64_t ip, uint64_t full_addr, uint32_t type) const;
+  void train(const sample& s, bool reused);
+  void update_sampler(uint32_t set, uint64_t full_addr, const feature_indices& indices, int yout);
+
+public:
+  explicit perceptron(CACHE* cache) : policy(cache), st(NUM_SET, NUM_WAY, NUM_CPUS, maxRRPV, 0) {}
+
+  void initialize_replacement() override;
+  uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) override;
+  void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                uint8_t hit) override;
+  uint64_t storage_bits() const override { return TABLE_BITS + SAMPLER_BITS + static_cast<uint64_t>(NUM_SET) * NUM_WAY * champsim::lg2(maxRRPV + 1); }
+  bool serialize_state(replacement::checkpoint::archive& ar) override
+  {
+    ar(st, weights, ip_history, sampler_clock);
+    return true;
+  }
+  void replacement_final_stats() override;
+};
+
+uint16_t table_index(uint64_t value, std::size_t feature)
+{
+  uint64_t x = (value + feature) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<uint16_t>((x ^ (x >> 29)) >> (64 - INDEX_BITS));
+}
+} // namespace
+
+void perceptron::initialize_replacement()
+{
+  // Evenly spaced sampled sets; there are never more than the cache has
+  std::size_t num_sampled = std::min<std::size_t>(SAMPLER_SETS_PER_CPU * NUM_CPUS, NUM_SET);
+  for (std::size_t i = 0; i < num_sampled; ++i)
+    st.rand_sets.push_back(i * NUM_SET / num_sampled);
+
+  st.sampler.resize(num_sampled * SAMPLER_WAYS);
+  st.index_sampled_sets();
+}
+
+feature_indices perceptron::hash_features(uint32_t cpu, uint64_t ip, uint64_t full_addr, uint32_t type) const
+{
+  const auto& history = ip_history[cpu];
+  uint64_t page = full_addr >> 12;
+  uint64_t block_in_page = (full_addr >> LOG2_BLOCK_SIZE) & ((1 << (12 - LOG2_BLOCK_SIZE)) - 1);
+  bool prefetch = access_type{type} == access_type::PREFETCH;
+
+  uint64_t values[NUM_FEATURES] = {
+      ip,
+      ip ^ (history[0] << 1),
+      ip ^ (history[1] << 2) ^ (history[2] << 3),
+      page,
+      (ip << 6) ^ block_in_page,
+      ip ^ (page << 7),
+      (ip << 3) ^ cpu,
+      (ip << 1) ^ prefetch,
+  };
+
+  feature_indices indices;
+  for (std::size_t f = 0; f < NUM_FEATURES; ++f)
+    indices[f] = table_index(values[f], f);
+  return indices;
+}
+
+void perceptron::train(const sample& s, bool reused)
+{
+  // Only when the prediction was wrong or not confident
+  if (reused ? s.yout <= -THETA : s.yout > THETA)
+    return;
+
+  ++trained;
+  for (std::size_t f = 0; f < NUM_FEATURES; ++f) {
+    int8_t& w = weights[f * TABLE_SIZE + s.indices[f]];
+    if (reused && w > WEIGHT_MIN)
+      --w;
+    else if (!reused && w < WEIGHT_MAX)
+      ++w;
+  }
+}
+
+void perceptron::update_sampler(uint32_t set, uint64_t full_addr, const feature_indices& indices, int yout)
+{
+  auto s_idx = st.sampler_slot[set];
+  if (s_idx < 0)
+    return;
+
+  auto s_set_begin = std::next(std::begin(st.sampler), s_idx * SAMPLER_WAYS);
+  auto s_set_end = std::next(s_set_begin, SAMPLER_WAYS);
+  uint64_t tag = (full_addr >> (LOG2_BLOCK_SIZE + champsim::lg2(NUM_SET))) & ((1 << TAG_BITS) - 1);
+
+  auto match = std::find_if(s_set_begin, s_set_end, [tag](const auto& x) { return x.valid && x.address == tag; });
+  if (match != s_set_end) {
+    train(*match, true);
+  } else {
+    match = std::min_element(s_set_begin, s_set_end, [](const auto& x, const auto& y) { return x.last_used < y.last_used; });
+    if (match->valid)
+      train(*match, false);
+    match->valid = true;
+    match->address = tag;
+  }
+
+  // The entry now stands for this access: reuse is judged from here on
+  match->indices = indices;
+  match->yout = static_cast<int16_t>(yout);
+  match->last_used = st.stamp_base + ++sampler_clock;
+}
+
+uint32_t perceptron::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
+{
+  auto set_rrpv = std::next(std::data(st.rrpv_values), set * NUM_WAY);
+  return rrpv::find_victim_and_age(set_rrpv, NUM_WAY, maxRRPV);
+}
+
+void perceptron::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
+                                          uint32_t type, uint8_t hit)
+{
+  if (way >= NUM_WAY)
+    return;
+  uint8_t& rrpv = st.rrpv_values[set * NUM_WAY + way];
+
+  // Writebacks are not predicted, and do not train
+  if (access_type{type} == access_type::WRITE) {
+    if (!hit)
+      rrpv = maxRRPV;
+    return;
+  }
+
+  auto indices = hash_features(triggering_cpu, ip, full_addr, type);
+  int yout = sum_weights(weights.data(), indices);
+  update_sampler(set, full_addr, indices, yout);
+
+  auto& history = ip_history[triggering_cpu];
+  if (ip != history[0]) {
+    history[2] = history[1];
+    history[1] = history[0];
+    history[0] = ip;
+  }
+
+  ++predictions;
+  predicted_dead += yout > DEAD_THRESHOLD;
+  if (hit)
+    rrpv = 0;
+  else if (yout > DEAD_THRESHOLD)
+    rrpv = maxRRPV;
+  else
+    rrpv = maxRRPV - 1;
+}
+
+void perceptron::replacement_final_stats()
+{
+  std::size_t rrpv_bits = static_cast<std::size_t>(NUM_SET) * NUM_WAY * champsim::lg2(maxRRPV + 1);
+  std::cout << NAME << " perceptron: " << predictions << " predictions, " << predicted_dead << " predicted dead, " << trained << " training updates" << std::endl;
+  std::cout << NAME << " perceptron storage: " << TABLE_BITS / 8 << " B weights + " << SAMPLER_BITS / 8 << " B sampler = " << (TABLE_BITS + SAMPLER_BITS) / 8192.0
+            << " KiB of a " << STORAGE_BUDGET_KIB * NUM_CPUS << " KiB budget, plus " << rrpv_bits / 8192.0 << " KiB of RRPVs" << std::endl;
+}
+
+REPLACEMENT_LEGACY_HOOKS(perceptron, )
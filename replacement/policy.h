@@ -0,0 +1,213 @@
+#ifndef REPLACEMENT_POLICY_H
+#define REPLACEMENT_POLICY_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+
+#include "cache.h"
+#include "checkpoint.h"
+#include "per_cache.h"
+
+namespace replacement
+{
+// A replacement policy bound to one cache.
+//
+// Each policy in replacement/ is a class derived from this one. Its hooks have
+// the same names and arguments as the CACHE replacement hooks, and the cache
+// geometry and clock are exposed under the CACHE member names, so a policy
+// body reads the same as it would inside CACHE. Per-cache state is simply a
+// member of the policy object.
+//
+// A policy file ends with REPLACEMENT_LEGACY_HOOKS, which defines the CACHE
+// hooks for a build that uses that policy alone. replacement/runtime compiles
+// every policy into one binary with REPLACEMENT_REGISTRY_ONLY defined, and
+// picks one per cache when the simulation starts.
+//
+// A policy that overrides serialize_state() can be checkpointed. With
+// REPLACEMENT_CHECKPOINT_SAVE=<prefix> its state is written to
+// <prefix>_<cache name>.ckpt at the end of warmup (nothing is written for a run
+// without warmup); with
+// REPLACEMENT_CHECKPOINT_LOAD=<prefix> it is read back from there right after
+// initialize_replacement(). Either can be given per cache, as
+// REPLACEMENT_CHECKPOINT_SAVE_<cache name>. The cache's own contents are not
+// part of the checkpoint, so a restored run still needs enough warmup to fill
+// the cache, but not to train the predictors. The checkpoint records the
+// policy and the geometry, and loading one from another policy or cache
+// geometry is an error.
+class policy
+{
+public:
+  explicit policy(CACHE* cache)
+      : cache(cache), NAME(cache->NAME), NUM_SET(cache->NUM_SET), NUM_WAY(cache->NUM_WAY), current_cycle(cache->current_cycle), warmup(cache->warmup)
+  {
+  }
+  virtual ~policy() = default;
+
+  policy(const policy&) = delete;
+  policy& operator=(const policy&) = delete;
+
+  virtual void initialize_replacement() {}
+  virtual uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,
+                               uint32_t type) = 0;
+  virtual void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
+                                        uint32_t type, uint8_t hit) = 0;
+  virtual void replacement_final_stats() {}
+
+  // Bits of state the policy adds to the cache, for tools that weigh hit rate
+  // against storage; 0 if the policy does not say
+  virtual uint64_t storage_bits() const { return 0; }
+
+  // List the state to checkpoint in ar, and return true; see checkpoint.h
+  virtual bool serialize_state(checkpoint::archive& ar) { return false; }
+
+  // Called by the hooks: after initialize_replacement(), and before every update
+  void restore_checkpoint();
+  void checkpoint_at_end_of_warmup()
+  {
+    if (!checkpoint_pending)
+      return;
+    if (warmup)
+      warmed_up = true;
+    else if (warmed_up)
+      save_checkpoint();
+    else {
+      // warmup was over before the first update: the predictor is untrained
+      checkpoint_pending = false;
+      std::cout << NAME << " replacement policy saw no warmup; not saving " << checkpoint_path << std::endl;
+    }
+  }
+
+protected:
+  // A policy setting from the environment: variable_<cache name> (e.g.
+  // BELADY_TRACE_LLC) if it is set, otherwise variable, otherwise nullptr
+  const char* setting(const std::string& variable) const
+  {
+    std::string cache_variable = variable + "_";
+    for (char c : NAME)
+      cache_variable += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+
+    if (const char* value = std::getenv(cache_variable.c_str()))
+      return value;
+    return std::getenv(variable.c_str());
+  }
+
+  CACHE* const cache;
+  const std::string& NAME;
+  const uint32_t NUM_SET;
+  const uint32_t NUM_WAY;
+  const uint64_t& current_cycle;
+  const bool& warmup;
+
+private:
+  bool checkpoint_pending = false;
+  bool warmed_up = false; // an update has been seen during warmup
+  std::string checkpoint_path;
+
+  void save_checkpoint();
+  void checkpoint_header(checkpoint::archive& ar);
+};
+
+inline void policy::checkpoint_header(checkpoint::archive& ar)
+{
+  char magic[sizeof(checkpoint::MAGIC)];
+  std::memcpy(magic, checkpoint::MAGIC, sizeof(magic));
+  ar(magic);
+  if (std::memcmp(magic, checkpoint::MAGIC, sizeof(magic)) != 0)
+    throw std::runtime_error("not a replacement checkpoint");
+  ar.expect(checkpoint::VERSION, "version");
+  ar.expect(std::string{typeid(*this).name()}, "policy");
+  ar.expect(NUM_SET, "number of sets");
+  ar.expect(NUM_WAY, "number of ways");
+  ar.expect(static_cast<uint32_t>(NUM_CPUS), "number of CPUs");
+}
+
+inline void policy::restore_checkpoint()
+{
+  auto path = [this](const char* prefix) { return std::string{prefix} + "_" + NAME + ".ckpt"; };
+
+  if (const char* load = setting("REPLACEMENT_CHECKPOINT_LOAD")) {
+    std::ifstream in{path(load), std::ios::binary};
+    if (!in)
+      throw std::runtime_error("cannot open replacement checkpoint " + path(load));
+    try {
+      checkpoint::archive ar{in};
+      checkpoint_header(ar);
+      if (!serialize_state(ar))
+        throw std::runtime_error("the policy cannot be checkpointed");
+    } catch (const std::runtime_error& e) {
+      throw std::runtime_error(path(load) + ": " + e.what());
+    }
+    std::cout << NAME << " replacement state restored from " << path(load) << std::endl;
+  }
+
+  if (const char* save = setting("REPLACEMENT_CHECKPOINT_SAVE")) {
+    checkpoint_path = path(save);
+    checkpoint_pending = true;
+  }
+}
+
+inline void policy::save_checkpoint()
+{
+  checkpoint_pending = false;
+  std::string part = checkpoint_path + ".part";
+  {
+    std::ofstream out{part, std::ios::binary};
+    checkpoint::archive ar{out};
+    checkpoint_header(ar);
+    if (!serialize_state(ar)) {
+      out.close();
+      std::remove(part.c_str());
+      std::cout << NAME << " replacement policy cannot be checkpointed; not saving " << checkpoint_path << std::endl;
+      return;
+    }
+    if (!out.flush())
+      throw std::runtime_error("cannot write " + part);
+  }
+  if (std::rename(part.c_str(), checkpoint_path.c_str()) != 0)
+    throw std::runtime_error("cannot move " + part + " to " + checkpoint_path);
+  std::cout << NAME << " replacement state saved to " << checkpoint_path << std::endl;
+}
+} // namespace replacement
+
+// Define the CACHE hooks for a build with this policy alone. prefix is empty
+// for the plain hook names, or the module prefix for the mangled ones
+// (repl_replacementDlruStat_ for lruStat).
+#if defined(REPLACEMENT_REGISTRY_ONLY)
+#define REPLACEMENT_LEGACY_HOOKS(policy_type, prefix)
+#else
+#define REPLACEMENT_LEGACY_HOOKS(policy_type, prefix)                                                                                                          \
+  namespace                                                                                                                                                    \
+  {                                                                                                                                                            \
+  replacement::per_cache<policy_type> prefix##legacy_policies;                                                                                                 \
+  }                                                                                                                                                            \
+  void CACHE::prefix##initialize_replacement()                                                                                                                 \
+  {                                                                                                                                                            \
+    auto& repl = ::prefix##legacy_policies.emplace(this, this);                                                                                                \
+    repl.initialize_replacement();                                                                                                                             \
+    repl.restore_checkpoint();                                                                                                                                 \
+  }                                                                                                                                                            \
+  uint32_t CACHE::prefix##find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,     \
+                                      uint32_t type)                                                                                                           \
+  {                                                                                                                                                            \
+    return ::prefix##legacy_policies[this].find_victim(triggering_cpu, instr_id, set, current_set, ip, full_addr, type);                                        \
+  }                                                                                                                                                            \
+  void CACHE::prefix##update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,     \
+                                               uint32_t type, uint8_t hit)                                                                                     \
+  {                                                                                                                                                            \
+    auto& repl = ::prefix##legacy_policies[this];                                                                                                              \
+    repl.checkpoint_at_end_of_warmup();                                                                                                                        \
+    repl.update_replacement_state(triggering_cpu, set, way, full_addr, ip, victim_addr, type, hit);                                                            \
+  }                                                                                                                                                            \
+  void CACHE::prefix##replacement_final_stats() { ::prefix##legacy_policies[this].replacement_final_stats(); }
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef REPLACEMENT_RRPV_SEARCH_H
+#define REPLACEMENT_RRPV_SEARCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace rrpv
+{
+namespace detail
+{
+#if defined(__SSE2__)
+inline uint8_t hmax(__m128i v)
+{
+  v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+  v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+  v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+  v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+  return static_cast<uint8_t>(_mm_cvtsi128_si32(v));
+}
+
+// lanes that take part in aging: every lane, or only the even ones
+template <unsigned AgeStride>
+inline __m128i age_lanes()
+{
+  return AgeStride == 1 ? _mm_set1_epi8(-1) : _mm_set1_epi16(0x00ff);
+}
+#endif
+
+#if defined(__AVX2__)
+template <unsigned AgeStride>
+inline __m256i age_lanes256()
+{
+  return AgeStride == 1 ? _mm256_set1_epi8(-1) : _mm256_set1_epi16(0x00ff);
+}
+#endif
+
+inline int first_set_bit(uint32_t mask) { return __builtin_ctz(mask); }
+} // namespace detail
+
+// RRIP victim search over one set of byte-wide RRPVs.
+//
+// Returns the first way whose RRPV equals max_rrpv. If there is none, the set
+// is aged in a single step by exactly the amount the classic "increment all
+// and search again" loop would have applied, then the first way that reached
+// max_rrpv is returned. Every RRPV must already be <= max_rrpv.
+//
+// AgeStride selects which ways are aged: 1 for all of them, 2 for only the even
+// ways (shipPP has always aged the set that way). Sets are processed 32 ways at
+// a time with AVX2, 16 at a time with SSE2, and the remainder in scalar code.
+template <unsigned AgeStride = 1>
+uint32_t find_victim_and_age(uint8_t* set_rrpv, std::size_t num_way, uint8_t max_rrpv)
+{
+  static_assert(AgeStride == 1 || AgeStride == 2, "only full or even-way aging is supported");
+
+  // pass 1: first way already at max_rrpv, and the oldest age among aged ways
+  uint8_t oldest = 0;
+  std::size_t i = 0;
+#if defined(__AVX2__)
+  {
+    const __m256i target = _mm256_set1_epi8(static_cast<char>(max_rrpv));
+    const __m256i lanes = detail::age_lanes256<AgeStride>();
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 32 <= num_way; i += 32) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(set_rrpv + i));
+      auto hits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, target)));
+      if (hits != 0)
+        return static_cast<uint32_t>(i + detail::first_set_bit(hits));
+      acc = _mm256_max_epu8(acc, _mm256_and_si256(v, lanes));
+    }
+    oldest = std::max(oldest, detail::hmax(_mm_max_epu8(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1))));
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i target = _mm_set1_epi8(static_cast<char>(max_rrpv));
+    const __m128i lanes = detail::age_lanes<AgeStride>();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= num_way; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set_rrpv + i));
+      auto hits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, target)));
+      if (hits != 0)
+        return static_cast<uint32_t>(i + detail::first_set_bit(hits));
+      acc = _mm_max_epu8(acc, _mm_and_si128(v, lanes));
+    }
+    oldest = std::max(oldest, detail::hmax(acc));
+  }
+#endif
+  for (; i < num_way; ++i) {
+    if (set_rrpv[i] == max_rrpv)
+      return static_cast<uint32_t>(i);
+    if (i % AgeStride == 0)
+      oldest = std::max(oldest, set_rrpv[i]);
+  }
+
+  // pass 2: age, and find the first way that reached max_rrpv
+  const auto delta = static_cast<uint8_t>(max_rrpv - oldest);
+  std::size_t victim = num_way;
+  i = 0;
+#if defined(__AVX2__)
+  {
+    const __m256i target = _mm256_set1_epi8(static_cast<char>(max_rrpv));
+    const __m256i step = _mm256_and_si256(_mm256_set1_epi8(static_cast<char>(delta)), detail::age_lanes256<AgeStride>());
+    for (; i + 32 <= num_way; i += 32) {
+      auto addr = reinterpret_cast<__m256i*>(set_rrpv + i);
+      __m256i v = _mm256_add_epi8(_mm256_loadu_si256(addr), step);
+      _mm256_storeu_si256(addr, v);
+      auto hits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, target)));
+      if (hits != 0 && victim == num_way)
+        victim = i + detail::first_set_bit(hits);
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i target = _mm_set1_epi8(static_cast<char>(max_rrpv));
+    const __m128i step = _mm_and_si128(_mm_set1_epi8(static_cast<char>(delta)), detail::age_lanes<AgeStride>());
+    for (; i + 16 <= num_way; i += 16) {
+      auto addr = reinterpret_cast<__m128i*>(set_rrpv + i);
+      __m128i v = _mm_add_epi8(_mm_loadu_si128(addr), step);
+      _mm_storeu_si128(addr, v);
+      auto hits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, target)));
+      if (hits != 0 && victim == num_way)
+        victim = i + detail::first_set_bit(hits);
+    }
+  }
+#endif
+  for (; i < num_way; i += AgeStride) {
+    set_rrpv[i] = static_cast<uint8_t>(set_rrpv[i] + delta);
+    if (set_rrpv[i] == max_rrpv && victim == num_way)
+      victim = i;
+  }
+
+  return static_cast<uint32_t>(victim);
+}
+} // namespace rrpv
+
+#endif
@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../belady/belady.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_belady(CACHE* cache) { return std::make_unique<belady>(cache); }
@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../hawkeye/hawkeye_new.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_hawkeye(CACHE* cache) { return std::make_unique<hawkeye>(cache); }
@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../lfu/lfu.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_lfu(CACHE* cache) { return std::make_unique<lfu>(cache); }
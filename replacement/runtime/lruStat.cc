@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../lruStat/lruStat.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_lruStat(CACHE* cache) { return std::make_unique<lru_stat>(cache); }
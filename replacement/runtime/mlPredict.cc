@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../mlPredict/mlPredict.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_mlPredict(CACHE* cache) { return std::make_unique<ml_predict>(cache); }
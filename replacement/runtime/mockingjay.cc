@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../mockingjay/mockingjay.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_mockingjay(CACHE* cache) { return std::make_unique<mockingjay>(cache); }
@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../mru/mru.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_mru(CACHE* cache) { return std::make_unique<mru>(cache); }
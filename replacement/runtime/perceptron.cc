@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../perceptron/perceptron.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_perceptron(CACHE* cache) { return std::make_unique<perceptron>(cache); }
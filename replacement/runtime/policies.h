@@ -0,0 +1,42 @@
+#ifndef REPLACEMENT_RUNTIME_POLICIES_H
+#define REPLACEMENT_RUNTIME_POLICIES_H
+
+#include <memory>
+
+#include "../policy.h"
+
+// One factory per policy compiled into the runtime module. Each is defined in
+// the wrapper file of the same name, which includes the policy's own source
+// with REPLACEMENT_REGISTRY_ONLY set.
+namespace replacement::runtime
+{
+using factory = std::unique_ptr<policy> (*)(CACHE*);
+
+std::unique_ptr<policy> make_belady(CACHE* cache);
+std::unique_ptr<policy> make_hawkeye(CACHE* cache);
+std::unique_ptr<policy> make_lfu(CACHE* cache);
+std::unique_ptr<policy> make_lruStat(CACHE* cache);
+std::unique_ptr<policy> make_mlPredict(CACHE* cache);
+std::unique_ptr<policy> make_mockingjay(CACHE* cache);
+std::unique_ptr<policy> make_mru(CACHE* cache);
+std::unique_ptr<policy> make_perceptron(CACHE* cache);
+std::unique_ptr<policy> make_shipCD(CACHE* cache);
+std::unique_ptr<policy> make_shipFrequency(CACHE* cache);
+std::unique_ptr<policy> make_shipPP(CACHE* cache);
+std::unique_ptr<policy> make_ship_mod(CACHE* cache);
+
+// Selectable policies, named after their directories in replacement/
+struct entry {
+  const char* name;
+  factory make;
+};
+
+constexpr entry registry[] = {
+    {"belady", make_belady},         {"hawkeye", make_hawkeye},       {"lfu", make_lfu},
+    {"lruStat", make_lruStat},       {"mlPredict", make_mlPredict},   {"mockingjay", make_mockingjay},
+    {"mru", make_mru},               {"perceptron", make_perceptron}, {"shipCD", make_shipCD},
+    {"shipFrequency", make_shipFrequency}, {"shipPP", make_shipPP}, {"ship_mod", make_ship_mod},
+};
+} // namespace replacement::runtime
+
+#endif
@@ -0,0 +1,136 @@
+// Every policy in replacement/ in one module, chosen per cache at startup.
+//
+// Set CHAMPSIM_REPLACEMENT to a policy name (its directory in replacement/) to
+// use it for every cache built with this module. CHAMPSIM_REPLACEMENT_<cache
+// name>, e.g. CHAMPSIM_REPLACEMENT_LLC, overrides it for one cache. With this
+// module as the LLC replacement, one binary serves a whole sweep and switching
+// policy needs no rebuild.
+//
+// CHAMPSIM_SHADOW_REPLACEMENT (or CHAMPSIM_SHADOW_REPLACEMENT_<cache name>)
+// takes a comma-separated list of further policies. Each one runs in a shadow
+// tag array fed with the cache's own access stream, and its hits and misses
+// are printed with the final stats next to those of the policy in charge.
+// Warmup trains the shadows but is not counted, as in the cache's own stats.
+// Comparing N policies then costs one trace pass instead of N.
+//
+// Only the policy in charge is checkpointed (REPLACEMENT_CHECKPOINT_SAVE and
+// _LOAD, see policy.h); shadows always start cold.
+
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "policies.h"
+#include "shadow.h"
+
+namespace
+{
+struct selection {
+  std::string primary_name;
+  std::unique_ptr<replacement::policy> primary;
+  replacement::runtime::access_counts primary_counts;
+  std::vector<replacement::runtime::shadow_cache> shadows;
+  bool counting = false; // the counts have been reset at the end of warmup
+};
+
+replacement::per_cache<selection> selections;
+
+// The per-cache variable if it is set, otherwise the global one, otherwise nullptr
+const char* lookup(const std::string& variable, const std::string& cache_name)
+{
+  std::string cache_variable = variable + "_";
+  for (char c : cache_name)
+    cache_variable += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+
+  if (const char* value = std::getenv(cache_variable.c_str()))
+    return value;
+  return std::getenv(variable.c_str());
+}
+
+std::unique_ptr<replacement::policy> make_policy(const std::string& name, CACHE* cache)
+{
+  for (const auto& entry : replacement::runtime::registry) {
+    if (name == entry.name)
+      return entry.make(cache);
+  }
+
+  std::string known;
+  for (const auto& entry : replacement::runtime::registry)
+    known += std::string{" "} + entry.name;
+  throw std::invalid_argument("unknown replacement policy " + name + " for " + cache->NAME + "; available:" + known);
+}
+} // namespace
+
+void CACHE::initialize_replacement()
+{
+  auto& sel = ::selections.emplace(this);
+
+  const char* primary = lookup("CHAMPSIM_REPLACEMENT", NAME);
+  if (primary == nullptr)
+    throw std::invalid_argument("no replacement policy selected for " + NAME + "; set CHAMPSIM_REPLACEMENT or CHAMPSIM_REPLACEMENT_" + NAME);
+  sel.primary_name = primary;
+  sel.primary = make_policy(sel.primary_name, this);
+  std::cout << NAME << " replacement policy: " << sel.primary_name << std::endl;
+
+  if (const char* shadows = lookup("CHAMPSIM_SHADOW_REPLACEMENT", NAME)) {
+    std::istringstream list{shadows};
+    std::string name;
+    while (std::getline(list, name, ',')) {
+      if (!name.empty())
+        sel.shadows.emplace_back(name, make_policy(name, this), *this);
+    }
+  }
+
+  sel.primary->initialize_replacement();
+  sel.primary->restore_checkpoint();
+  for (auto& shadow : sel.shadows) {
+    std::cout << NAME << " shadow replacement policy: " << shadow.policy_name() << std::endl;
+    shadow.initialize();
+  }
+}
+
+uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
+{
+  return ::selections[this].primary->find_victim(triggering_cpu, instr_id, set, current_set, ip, full_addr, type);
+}
+
+void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                     uint8_t hit)
+{
+  auto& sel = ::selections[this];
+  sel.primary->checkpoint_at_end_of_warmup();
+  sel.primary->update_replacement_state(triggering_cpu, set, way, full_addr, ip, victim_addr, type, hit);
+
+  if (!sel.shadows.empty()) {
+    if (!warmup && !sel.counting) {
+      sel.counting = true;
+      sel.primary_counts = {};
+      for (auto& shadow : sel.shadows)
+        shadow.reset_counts();
+    }
+    sel.primary_counts.record(type, hit);
+    for (auto& shadow : sel.shadows)
+      shadow.access(triggering_cpu, set, full_addr, ip, type);
+  }
+}
+
+void CACHE::replacement_final_stats()
+{
+  auto& sel = ::selections[this];
+  sel.primary->replacement_final_stats();
+
+  if (!sel.shadows.empty()) {
+    std::cout << "\n" << NAME << " replacement comparison (hits and fills seen by the replacement policy)\n";
+    sel.primary_counts.print(std::cout, NAME + " " + sel.primary_name + " (primary)");
+    for (auto& shadow : sel.shadows) {
+      shadow.final_stats();
+      shadow.counts().print(std::cout, NAME + " " + shadow.policy_name() + " (shadow)");
+    }
+    std::cout << std::flush;
+  }
+}
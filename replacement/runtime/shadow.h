@@ -0,0 +1,117 @@
+#ifndef REPLACEMENT_RUNTIME_SHADOW_H
+#define REPLACEMENT_RUNTIME_SHADOW_H
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../policy.h"
+
+namespace replacement::runtime
+{
+// Hits and misses by access type
+struct access_counts {
+  static constexpr std::size_t NUM_TYPES = static_cast<std::size_t>(access_type::NUM_TYPES);
+  static constexpr const char* TYPE_NAMES[] = {"LOAD", "RFO", "PREFETCH", "WRITE", "TRANSLATION"};
+  static_assert(std::size(TYPE_NAMES) == NUM_TYPES, "one name per access type");
+
+  std::array<uint64_t, NUM_TYPES> hits{};
+  std::array<uint64_t, NUM_TYPES> misses{};
+
+  void record(uint32_t type, bool hit) { (hit ? hits : misses).at(type)++; }
+
+  // Same layout as the simulator's own cache stats, with the policy name in the label
+  void print(std::ostream& os, const std::string& label) const
+  {
+    uint64_t total_hits = 0, total_misses = 0;
+    for (std::size_t type = 0; type < NUM_TYPES; ++type) {
+      total_hits += hits[type];
+      total_misses += misses[type];
+    }
+    print_line(os, label, "TOTAL", total_hits, total_misses);
+    for (std::size_t type = 0; type < NUM_TYPES; ++type)
+      print_line(os, label, TYPE_NAMES[type], hits[type], misses[type]);
+  }
+
+private:
+  static void print_line(std::ostream& os, const std::string& label, const char* type, uint64_t hit, uint64_t miss)
+  {
+    os << label << " " << std::setw(11) << std::left << type << std::right << " ACCESS: " << std::setw(10) << (hit + miss) << " HIT: " << std::setw(10) << hit
+       << " MISS: " << std::setw(10) << miss << "\n";
+  }
+};
+
+// A tag array that replays the cache's access stream under another policy.
+//
+// The cache calls access() once for every hit and every fill it reports to its
+// own policy, so every shadow sees exactly the stream the real cache saw. The
+// shadow keeps its own blocks and policy state, and only counts hits and
+// misses. The timing of the run comes from the real cache and its policy.
+class shadow_cache
+{
+public:
+  shadow_cache(std::string name, std::unique_ptr<policy> repl, const CACHE& cache)
+      : name(std::move(name)), repl(std::move(repl)), num_way(cache.NUM_WAY), blocks(cache.NUM_SET * cache.NUM_WAY)
+  {
+  }
+
+  const std::string& policy_name() const { return name; }
+  const access_counts& counts() const { return stats; }
+  void reset_counts() { stats = {}; }
+  uint64_t storage_bits() const { return repl->storage_bits(); }
+
+  void initialize() { repl->initialize_replacement(); }
+  void final_stats() { repl->replacement_final_stats(); }
+
+  void access(uint32_t triggering_cpu, uint32_t set, uint64_t full_addr, uint64_t ip, uint32_t type)
+  {
+    BLOCK* current_set = &blocks[set * num_way];
+    uint64_t block_addr = full_addr >> LOG2_BLOCK_SIZE;
+
+    for (uint32_t way = 0; way < num_way; ++way) {
+      if (current_set[way].valid && (current_set[way].address >> LOG2_BLOCK_SIZE) == block_addr) {
+        stats.record(type, true);
+        if (access_type{type} == access_type::WRITE)
+          current_set[way].dirty = true;
+        repl->update_replacement_state(triggering_cpu, set, way, full_addr, ip, 0, type, 1);
+        return;
+      }
+    }
+
+    stats.record(type, false);
+
+    uint32_t way = 0;
+    while (way < num_way && current_set[way].valid)
+      ++way;
+    if (way == num_way)
+      way = repl->find_victim(triggering_cpu, 0, set, current_set, ip, full_addr, type);
+
+    uint64_t victim_addr = 0;
+    if (way < num_way) {
+      BLOCK& fill = current_set[way];
+      victim_addr = fill.valid ? fill.address : 0;
+      fill.valid = true;
+      fill.prefetch = access_type{type} == access_type::PREFETCH;
+      fill.dirty = access_type{type} == access_type::WRITE;
+      fill.address = full_addr;
+      fill.ip = ip;
+      fill.cpu = triggering_cpu;
+    }
+    repl->update_replacement_state(triggering_cpu, set, way, full_addr, ip, victim_addr, type, 0);
+  }
+
+private:
+  std::string name;
+  std::unique_ptr<policy> repl;
+  uint32_t num_way;
+  std::vector<BLOCK> blocks;
+  access_counts stats;
+};
+} // namespace replacement::runtime
+
+#endif
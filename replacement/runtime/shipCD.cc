@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../shipCD/shipCD.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_shipCD(CACHE* cache) { return std::make_unique<ship_cd>(cache); }
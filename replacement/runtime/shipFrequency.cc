@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../shipFrequency/shipFrequency.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_shipFrequency(CACHE* cache) { return std::make_unique<ship_frequency>(cache); }
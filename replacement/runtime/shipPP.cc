@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../shipPP/shipPP.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_shipPP(CACHE* cache) { return std::make_unique<ship_pp>(cache); }
@@ -0,0 +1,5 @@
+#define REPLACEMENT_REGISTRY_ONLY
+#include "../ship_mod/ship_mod.cc"
+#include "policies.h"
+
+std::unique_ptr<replacement::policy> replacement::runtime::make_ship_mod(CACHE* cache) { return std::make_unique<ship_mod>(cache); }
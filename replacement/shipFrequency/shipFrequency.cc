@@ -1,92 +1,104 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
-#include <map>
-#include <utility>
 #include <vector>
 
 #include "cache.h"
 #include "msl/bits.h"
+#include "../rrpv_search.h"
+#include "../policy.h"
+#include "../ship_state.h"
 
 namespace
 {
-constexpr int maxRRPV = 3;
-constexpr std::size_t SHCT_SIZE = 16384;
-constexpr unsigned SHCT_PRIME = 16381;
-constexpr std::size_t SAMPLER_SET = (256 * NUM_CPUS);
-constexpr unsigned SHCT_MAX = 7;
-constexpr unsigned FREQUENCY_MAX = 15; // Maximum frequency count
-
-// Sampler structure
-class SAMPLER_class
-{
-public:
-    bool valid = false;
-    uint8_t used = 0;
-    uint64_t address = 0, cl_addr = 0, ip = 0;
-    uint64_t last_used = 0;
+// Defaults of the SHIP_* settings, see ship::params
+constexpr ship::params DEFAULTS{3, 16384, 16381, 256, 7};
+constexpr unsigned FREQUENCY_MAX = 15; // Default of SHIP_FREQUENCY_MAX, the maximum frequency count
+
+// SHiP state plus frequency tracking, one table per triggering CPU
+struct frequency_state : ship::state<> {
+    std::vector<std::vector<unsigned>> frequency_table;
+
+    frequency_state() = default;
+    frequency_state(std::size_t num_set, std::size_t num_way, std::size_t num_cpus, int initial_rrpv, std::size_t shct_size)
+        : ship::state<>(num_set, num_way, num_cpus, initial_rrpv, shct_size), frequency_table(num_cpus, std::vector<unsigned>(shct_size))
+    {
+    }
+
+    void serialize_state(replacement::checkpoint::archive& ar)
+    {
+        ship::state<>::serialize_state(ar);
+        ar(frequency_table);
+    }
 };
 
-// Sampler and prediction table maps
-std::map<CACHE*, std::vector<std::size_t>> rand_sets;
-std::map<CACHE*, std::vector<SAMPLER_class>> sampler;
-std::map<CACHE*, std::vector<int>> rrpv_values;
+class ship_frequency : public replacement::policy
+{
+    ship::params cfg = DEFAULTS;
+    unsigned frequency_max = FREQUENCY_MAX;
+    frequency_state st;
 
-// Prediction table with frequency
-std::map<std::pair<CACHE*, std::size_t>, std::array<unsigned, SHCT_SIZE>> SHCT;
-std::map<std::pair<CACHE*, std::size_t>, std::array<unsigned, SHCT_SIZE>> frequency_table; // Frequency tracking
+public:
+    using policy::policy;
+
+    void initialize_replacement() override;
+    uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type) override;
+    void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                  uint8_t hit) override;
+    uint64_t storage_bits() const override
+    {
+        return cfg.storage_bits(NUM_SET, NUM_WAY, NUM_CPUS) + NUM_CPUS * cfg.shct_size * ship::params::bit_width(frequency_max);
+    }
+    bool serialize_state(replacement::checkpoint::archive& ar) override
+    {
+        ar.expect(cfg, "SHiP configuration");
+        ar.expect(frequency_max, "SHIP_FREQUENCY_MAX");
+        ar(st);
+        return true;
+    }
+};
 } // namespace
 
 // Initialize replacement state
-void CACHE::initialize_replacement()
+void ship_frequency::initialize_replacement()
 {
+    cfg.read([this](const char* name) { return setting(name); });
+    if (const char* value = setting("SHIP_FREQUENCY_MAX"))
+        ship::parse_setting("SHIP_FREQUENCY_MAX", value, frequency_max);
+    st = frequency_state(NUM_SET, NUM_WAY, NUM_CPUS, cfg.max_rrpv, cfg.shct_size);
+    std::size_t sampler_sets = cfg.sampled_sets(NUM_SET, NUM_CPUS);
+    std::cout << NAME << " shipFrequency: " << cfg << ", frequency counters up to " << frequency_max << ", " << storage_bits() << " bits" << std::endl;
+
     // Set random seed and generator
     std::size_t rand_seed = 1103515245 + 12345;
 
     // Initialize random sampler sets
-    rand_sets[this].clear();
-    for (std::size_t i = 0; i < SAMPLER_SET; ++i) {
-        rand_sets[this].push_back(rand_seed % NUM_SET);
+    for (std::size_t i = 0; i < sampler_sets; ++i) {
+        st.rand_sets.push_back(rand_seed % NUM_SET);
         rand_seed = rand_seed * 1103515245 + 12345;
     }
 
-    // Initialize RRPV values
-    rrpv_values[this].resize(NUM_SET * NUM_WAY, maxRRPV);
-
-    // Initialize SHCT and frequency table entries
-    for (std::size_t i = 0; i < SAMPLER_SET; ++i) {
-        SHCT[std::make_pair(this, i)].fill(0);
-        frequency_table[std::make_pair(this, i)].fill(0);
-    }
-
     // Initialize sampler
-    sampler[this].resize(SAMPLER_SET * NUM_WAY);
+    st.sampler.resize(sampler_sets * NUM_WAY);
+    st.index_sampled_sets();
 }
 
 // Find replacement victim
-uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
+uint32_t ship_frequency::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
 {
-    // Look for the maxRRPV line
-    auto begin = std::next(std::begin(rrpv_values[this]), set * NUM_WAY);
-    auto end = std::next(begin, NUM_WAY);
-    auto victim = std::find(begin, end, maxRRPV);
-
-    // Break ties using the lowest frequency
-    while (victim == end) {
-        for (auto it = begin; it != end; ++it) {
-            ++(*it);
-        }
-        victim = std::find(begin, end, maxRRPV);
-    }
+    assert(triggering_cpu < NUM_CPUS);
+    auto& frequency_table = st.frequency_table[triggering_cpu];
 
-    // Find the cache line with the lowest frequency among maxRRPV candidates
-    uint32_t victim_index = static_cast<uint32_t>(std::distance(begin, victim));
-    unsigned min_frequency = FREQUENCY_MAX + 1;
+    // Look for the maxRRPV line, aging the set if there is none
+    auto set_rrpv = std::next(std::data(st.rrpv_values), set * NUM_WAY);
+    uint32_t victim_index = rrpv::find_victim_and_age(set_rrpv, NUM_WAY, cfg.max_rrpv);
 
-    for (auto it = begin; it != end; ++it) {
-        auto index = static_cast<uint32_t>(std::distance(begin, it));
-        auto freq = frequency_table[std::make_pair(this, triggering_cpu)][index % SHCT_SIZE];
-        if (*it == maxRRPV && freq < min_frequency) {
+    // Break ties using the lowest frequency among maxRRPV candidates
+    unsigned min_frequency = frequency_max + 1;
+
+    for (uint32_t index = 0; index < NUM_WAY; ++index) {
+        auto freq = frequency_table[index % cfg.shct_size];
+        if (set_rrpv[index] == cfg.max_rrpv && freq < min_frequency) {
             min_frequency = freq;
             victim_index = index;
         }
@@ -96,36 +108,40 @@ uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t
 }
 
 // Update replacement state on cache hits and fills
-void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
-                                     uint8_t hit)
+void ship_frequency::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                              uint8_t hit)
 {
     // Handle writeback access
     if (access_type{type} == access_type::WRITE) {
         if (!hit) {
-            rrpv_values[this][set * NUM_WAY + way] = maxRRPV - 1;
+            st.rrpv_values[set * NUM_WAY + way] = cfg.max_rrpv - 1;
         }
         return;
     }
 
+    assert(triggering_cpu < NUM_CPUS);
+    auto& SHCT = st.SHCT[triggering_cpu];
+    auto& frequency_table = st.frequency_table[triggering_cpu];
+
     // Update sampler
-    auto s_idx = std::find(std::begin(rand_sets[this]), std::end(rand_sets[this]), set);
-    if (s_idx != std::end(rand_sets[this])) {
-        auto s_set_begin = std::next(std::begin(sampler[this]), std::distance(std::begin(rand_sets[this]), s_idx) * NUM_WAY);
+    auto s_idx = st.sampler_slot[set];
+    if (s_idx >= 0) {
+        auto s_set_begin = std::next(std::begin(st.sampler), s_idx * NUM_WAY);
         auto s_set_end = std::next(s_set_begin, NUM_WAY);
 
         // Check hit
         auto match = std::find_if(s_set_begin, s_set_end,
                                   [addr = full_addr, shamt = 8 + champsim::lg2(NUM_WAY)](auto x) { return x.valid && (x.address >> shamt) == (addr >> shamt); });
         if (match != s_set_end) {
-            auto SHCT_idx = match->ip % SHCT_PRIME;
+            auto SHCT_idx = match->ip % cfg.shct_prime;
 
             if (match->used) {
                 // Decay frequency and reuse prediction
-                if (frequency_table[std::make_pair(this, triggering_cpu)][SHCT_idx] > 0) {
-                    frequency_table[std::make_pair(this, triggering_cpu)][SHCT_idx]--;
+                if (frequency_table[SHCT_idx] > 0) {
+                    frequency_table[SHCT_idx]--;
                 }
-                if (SHCT[std::make_pair(this, triggering_cpu)][SHCT_idx] > 0) {
-                    SHCT[std::make_pair(this, triggering_cpu)][SHCT_idx]--;
+                if (SHCT[SHCT_idx] > 0) {
+                    SHCT[SHCT_idx]--;
                 }
             }
             match->used = 1;
@@ -133,12 +149,12 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
             match = std::min_element(s_set_begin, s_set_end, [](auto x, auto y) { return x.last_used < y.last_used; });
 
             if (match->used) {
-                auto SHCT_idx = match->ip % SHCT_PRIME;
-                if (frequency_table[std::make_pair(this, triggering_cpu)][SHCT_idx] < FREQUENCY_MAX) {
-                    frequency_table[std::make_pair(this, triggering_cpu)][SHCT_idx]++;
+                auto SHCT_idx = match->ip % cfg.shct_prime;
+                if (frequency_table[SHCT_idx] < frequency_max) {
+                    frequency_table[SHCT_idx]++;
                 }
-                if (SHCT[std::make_pair(this, triggering_cpu)][SHCT_idx] < SHCT_MAX) {
-                    SHCT[std::make_pair(this, triggering_cpu)][SHCT_idx]++;
+                if (SHCT[SHCT_idx] < cfg.shct_max) {
+                    SHCT[SHCT_idx]++;
                 }
             }
 
@@ -149,21 +165,20 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
         }
 
         // Update LRU state
-        match->last_used = current_cycle;
+        match->last_used = st.stamp_base + current_cycle;
     }
 
     if (hit) {
-        rrpv_values[this][set * NUM_WAY + way] = 0;
+        st.rrpv_values[set * NUM_WAY + way] = 0;
     } else {
         // SHIP-Frequency prediction
-        auto SHCT_idx = ip % SHCT_PRIME;
+        auto SHCT_idx = ip % cfg.shct_prime;
 
-        rrpv_values[this][set * NUM_WAY + way] = maxRRPV - 1;
-        if (frequency_table[std::make_pair(this, triggering_cpu)][SHCT_idx] >= (FREQUENCY_MAX / 2)) {
-            rrpv_values[this][set * NUM_WAY + way] = maxRRPV;
+        st.rrpv_values[set * NUM_WAY + way] = cfg.max_rrpv - 1;
+        if (frequency_table[SHCT_idx] >= (frequency_max / 2)) {
+            st.rrpv_values[set * NUM_WAY + way] = cfg.max_rrpv;
         }
     }
 }
 
-// Use this function to print custom stats at the end of simulation
-void CACHE::replacement_final_stats() {}
+REPLACEMENT_LEGACY_HOOKS(ship_frequency, )
@@ -0,0 +1,172 @@
+#ifndef REPLACEMENT_SHIP_STATE_H
+#define REPLACEMENT_SHIP_STATE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "checkpoint.h"
+#include "msl/bits.h"
+
+namespace ship
+{
+// sampler structure
+class SAMPLER_class
+{
+public:
+  bool valid = false;
+  uint8_t used = 0;
+  uint64_t address = 0, cl_addr = 0, ip = 0;
+  uint64_t last_used = 0;
+};
+
+// Set knob to the number in text, the value of setting name
+template <typename Knob>
+void parse_setting(const char* name, const char* text, Knob& knob)
+{
+  try {
+    knob = static_cast<Knob>(std::stoull(text));
+  } catch (const std::logic_error&) {
+    throw std::invalid_argument(std::string{name} + " must be a number, not " + text);
+  }
+}
+
+// The knobs of a SHiP-family policy, fixed when it initializes. A policy
+// starts from its own defaults, and read() overrides them with the settings
+// SHIP_MAX_RRPV, SHIP_SHCT_SIZE, SHIP_SHCT_PRIME, SHIP_SAMPLER_SETS and
+// SHIP_SHCT_MAX (each also as <name>_<cache name>, see policy::setting). A new
+// SHIP_SHCT_SIZE without SHIP_SHCT_PRIME indexes the table by the largest
+// prime that fits in it.
+struct params {
+  unsigned max_rrpv;
+  std::size_t shct_size;    // SHCT entries per CPU
+  std::size_t shct_prime;   // the SHCT is indexed by ip % shct_prime
+  std::size_t sampler_sets; // per CPU, at most the number of sets in all
+  unsigned shct_max;        // SHCT counters saturate here
+
+  // setting(name) returns the value of a setting, or nullptr
+  template <typename Setting>
+  void read(Setting&& setting)
+  {
+    auto value = [&setting](const char* name, auto& knob) {
+      if (const char* text = setting(name)) {
+        parse_setting(name, text, knob);
+        return true;
+      }
+      return false;
+    };
+
+    value("SHIP_MAX_RRPV", max_rrpv);
+    bool resized = value("SHIP_SHCT_SIZE", shct_size);
+    if (!value("SHIP_SHCT_PRIME", shct_prime) && resized)
+      shct_prime = largest_prime(shct_size);
+    value("SHIP_SAMPLER_SETS", sampler_sets);
+    value("SHIP_SHCT_MAX", shct_max);
+
+    if (max_rrpv == 0 || max_rrpv > 255)
+      throw std::invalid_argument("SHIP_MAX_RRPV must be between 1 and 255");
+    if (shct_prime == 0 || shct_prime > shct_size)
+      throw std::invalid_argument("SHIP_SHCT_PRIME must be between 1 and SHIP_SHCT_SIZE");
+    if (shct_max == 0)
+      throw std::invalid_argument("SHIP_SHCT_MAX must be at least 1");
+  }
+
+  std::size_t sampled_sets(std::size_t num_set, std::size_t num_cpus) const { return std::min(sampler_sets * num_cpus, num_set); }
+
+  // Bits of state the policy adds to a cache: the SHCTs, the sampler, with a
+  // 16-bit partial tag, the signature, valid and used bits and an LRU position
+  // per entry, and the RRPVs.
+  uint64_t storage_bits(std::size_t num_set, std::size_t num_way, std::size_t num_cpus) const
+  {
+    uint64_t shct_bits = static_cast<uint64_t>(num_cpus) * shct_size * bit_width(shct_max);
+    uint64_t sampler_entry_bits = 16 + bit_width(shct_prime - 1) + 2 + champsim::lg2(num_way);
+    uint64_t sampler_bits = static_cast<uint64_t>(sampled_sets(num_set, num_cpus)) * num_way * sampler_entry_bits;
+    return shct_bits + sampler_bits + static_cast<uint64_t>(num_set) * num_way * bit_width(max_rrpv);
+  }
+
+  bool operator!=(const params& other) const
+  {
+    return std::tie(max_rrpv, shct_size, shct_prime, sampler_sets, shct_max)
+           != std::tie(other.max_rrpv, other.shct_size, other.shct_prime, other.sampler_sets, other.shct_max);
+  }
+
+  static unsigned bit_width(uint64_t value) { return value == 0 ? 0 : champsim::lg2(value) + 1; }
+
+  static std::size_t largest_prime(std::size_t n)
+  {
+    auto is_prime = [](std::size_t p) {
+      for (std::size_t d = 2; d * d <= p; ++d)
+        if (p % d == 0)
+          return false;
+      return p >= 2;
+    };
+    while (n > 2 && !is_prime(n))
+      --n;
+    return std::max<std::size_t>(n, 1);
+  }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const params& p)
+{
+  return os << "maxRRPV " << p.max_rrpv << ", SHCT " << p.shct_size << " x " << params::bit_width(p.shct_max) << " bits indexed by ip % " << p.shct_prime << ", "
+            << p.sampler_sets << " sampled sets per CPU";
+}
+
+// Everything one SHiP-family policy keeps for a single cache, held by that
+// cache's policy object. Sample is the sampler entry; a policy that trains on
+// more than the IP can derive its own from SAMPLER_class.
+template <typename Sample = SAMPLER_class>
+struct state {
+  std::vector<std::size_t> rand_sets;
+  std::vector<Sample> sampler;
+
+  // position of each set in rand_sets, or -1 if the set is not sampled
+  std::vector<int32_t> sampler_slot;
+  std::vector<uint8_t> rrpv_values; // one byte per way, searched by rrpv::find_victim_and_age
+
+  // prediction table, one per triggering CPU
+  std::vector<std::vector<unsigned>> SHCT;
+
+  // added to every new sampler stamp; nonzero only after a restore
+  uint64_t stamp_base = 0;
+
+  state() = default;
+  state(std::size_t num_set, std::size_t num_way, std::size_t num_cpus, uint8_t initial_rrpv, std::size_t shct_size)
+      : sampler_slot(num_set, -1), rrpv_values(num_set * num_way, initial_rrpv), SHCT(num_cpus, std::vector<unsigned>(shct_size))
+  {
+  }
+
+  // Call once rand_sets is filled. A set listed more than once keeps its
+  // first position, which is what std::find over rand_sets would return.
+  void index_sampled_sets()
+  {
+    for (std::size_t i = rand_sets.size(); i-- > 0;)
+      sampler_slot[rand_sets[i]] = static_cast<int32_t>(i);
+  }
+
+  void serialize_state(replacement::checkpoint::archive& ar)
+  {
+    ar(rand_sets, sampler, sampler_slot, rrpv_values, SHCT);
+
+    // Sampler recency is stamped with cycles of the run that saved it. Keep
+    // only the order as ranks 0..N-1, and start new stamps at N so that
+    // anything the restored run touches is more recent.
+    if (ar.loading()) {
+      std::vector<std::size_t> order(sampler.size());
+      std::iota(order.begin(), order.end(), std::size_t{0});
+      std::stable_sort(order.begin(), order.end(), [this](auto x, auto y) { return sampler[x].last_used < sampler[y].last_used; });
+      for (std::size_t rank = 0; rank < order.size(); ++rank)
+        sampler[order[rank]].last_used = rank;
+      stamp_base = sampler.size();
+    }
+  }
+};
+} // namespace ship
+
+#endif
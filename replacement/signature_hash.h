@@ -0,0 +1,74 @@
+#ifndef REPLACEMENT_SIGNATURE_HASH_H
+#define REPLACEMENT_SIGNATURE_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(CHAMPSIM_HW_CRC_SIGNATURES)
+#if !defined(__SSE4_2__)
+#error "CHAMPSIM_HW_CRC_SIGNATURES needs SSE4.2 (build with -msse4.2)"
+#endif
+#include <nmmintrin.h>
+#endif
+
+// PC and address hashing shared by the replacement policies.
+//
+// Hawkeye and Mockingjay both hash with a bit-serial loop over the reflected
+// CRC-32 polynomial, for 32 and 3 steps respectively. crc<Steps>() gives the
+// same bits from lookup tables: eight steps per byte-table lookup, then one
+// lookup in a smaller table for whatever is left over. Because each step is
+// linear, the result does not depend on how the steps are grouped.
+//
+// hash<Steps>() is what the policies call. It is crc<Steps>() unless the build
+// defines CHAMPSIM_HW_CRC_SIGNATURES, in which case it is the SSE4.2 crc32
+// instruction (the CRC-32C polynomial). That is faster but gives different
+// signatures, so results are not comparable with table-driven runs.
+namespace signature_hash
+{
+constexpr uint64_t CRC_POLYNOMIAL = 3988292384ULL; // 0xEDB88320
+
+constexpr uint64_t crc_step(uint64_t value) { return (value & 1) ? ((value >> 1) ^ CRC_POLYNOMIAL) : (value >> 1); }
+
+template <unsigned Bits>
+constexpr std::array<uint64_t, (std::size_t{1} << Bits)> make_crc_table()
+{
+  std::array<uint64_t, (std::size_t{1} << Bits)> table{};
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    uint64_t value = i;
+    for (unsigned step = 0; step < Bits; ++step)
+      value = crc_step(value);
+    table[i] = value;
+  }
+  return table;
+}
+
+template <unsigned Bits>
+inline constexpr auto crc_table = make_crc_table<Bits>();
+
+// Steps iterations of the bit-serial CRC, bit-identical to the original loops
+template <unsigned Steps>
+inline uint64_t crc(uint64_t value)
+{
+  for (unsigned i = 0; i < Steps / 8; ++i)
+    value = (value >> 8) ^ crc_table<8>[value & 0xff];
+
+  if constexpr (Steps % 8 != 0) {
+    constexpr unsigned rest = Steps % 8;
+    value = (value >> rest) ^ crc_table<rest>[value & ((1u << rest) - 1)];
+  }
+  return value;
+}
+
+template <unsigned Steps>
+inline uint64_t hash(uint64_t value)
+{
+#if defined(CHAMPSIM_HW_CRC_SIGNATURES)
+  return _mm_crc32_u64(0, value);
+#else
+  return crc<Steps>(value);
+#endif
+}
+} // namespace signature_hash
+
+#endif
@@ -0,0 +1,61 @@
+// The parts of ChampSim's inc/cache.h that the replacement policies use, so
+// that llc_replay can compile them without the rest of the simulator. Keep the
+// names and signatures in step with the real header.
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Number of cores the policies are sized for. Traces from an N-core run need a
+// build with -DLLC_REPLAY_NUM_CPUS=N.
+#ifndef LLC_REPLAY_NUM_CPUS
+#define LLC_REPLAY_NUM_CPUS 1
+#endif
+
+constexpr std::size_t NUM_CPUS = LLC_REPLAY_NUM_CPUS;
+constexpr unsigned LOG2_BLOCK_SIZE = 6;
+constexpr std::size_t BLOCK_SIZE = std::size_t{1} << LOG2_BLOCK_SIZE;
+
+enum class access_type : unsigned { LOAD = 0, RFO, PREFETCH, WRITE, TRANSLATION, NUM_TYPES };
+
+struct BLOCK {
+  bool valid = false;
+  bool prefetch = false;
+  bool dirty = false;
+
+  uint64_t address = 0;
+  uint64_t v_address = 0;
+  uint64_t data = 0;
+  uint64_t ip = 0;
+  uint64_t cpu = 0;
+  uint64_t instr_id = 0;
+};
+
+namespace champsim
+{
+struct operable {
+  uint64_t current_cycle = 0;
+  bool warmup = true;
+};
+} // namespace champsim
+
+class CACHE : public champsim::operable
+{
+public:
+  CACHE(std::string name, uint32_t num_set, uint32_t num_way) : NAME(std::move(name)), NUM_SET(num_set), NUM_WAY(num_way) {}
+
+  const std::string NAME;
+  const uint32_t NUM_SET;
+  const uint32_t NUM_WAY;
+
+  // Defined by replacement/runtime/runtime.cc; llc_replay calls the policies directly
+  void initialize_replacement();
+  uint32_t find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type);
+  void update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr, uint32_t type,
+                                uint8_t hit);
+  void replacement_final_stats();
+};
+
+#endif
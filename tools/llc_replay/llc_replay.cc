@@ -0,0 +1,197 @@
+// Replay a captured LLC access stream against replacement policies, without
+// the rest of the simulator.
+//
+// The input is one or more lruStat traces (one per CPU, as lruStat writes
+// them) or column files from tools/lrustat2col; they are merged by cycle into
+// one stream. Every record is replayed on
+// a plain tag array per policy, through the same hooks the cache calls, and
+// the hits and misses of each policy are printed at the end. All policies
+// share one pass over the trace.
+//
+// Build from the repository root (add the lruStat codec flags to read
+// compressed traces, and -DLLC_REPLAY_NUM_CPUS=N for traces from N cores):
+//   g++ -O2 -std=c++17 -I tools/llc_replay -I replacement/lruStat -I replacement/runtime
+//       tools/llc_replay/llc_replay.cc replacement/runtime/*.cc -lpthread -o llc_replay
+//
+// Usage: llc_replay [options] <trace.bin | trace.col>...
+//   --policy a,b,...  policies to replay (default: every registered policy but
+//                     lruStat, which is LRU but also writes a trace of the replay,
+//                     and mlPredict unless MLPREDICT_MODEL names its model)
+//   --sets N          LLC sets (default 2048)
+//   --ways N          LLC ways (default 16)
+//   --warmup N        replay the first N records as warmup, without counting them
+//   --list            print the registered policies and exit
+//
+// The stream is the one the captured cache reported to its replacement policy,
+// so a replay with the captured geometry sees the same hits and fills. With a
+// different geometry the set index is recomputed from the address; the stream
+// is then an approximation, since the captured cache filtered it with its own
+// contents. Capture with lruStat filters off (the defaults) for replay.
+//
+// belady is given the replayed trace as its future (BELADY_TRACE, if not set
+// already), so its row is the optimal hit count for the replayed stream: the
+// headroom left for every other policy.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "policies.h"
+#include "access_stream.h"
+#include "shadow.h"
+
+namespace
+{
+struct replay {
+  replacement::runtime::shadow_cache tags;
+  double seconds = 0;
+};
+
+std::unique_ptr<replacement::policy> make_policy(const std::string& name, CACHE* cache)
+{
+  for (const auto& entry : replacement::runtime::registry) {
+    if (name == entry.name)
+      return entry.make(cache);
+  }
+  throw std::invalid_argument("unknown replacement policy " + name + "; see --list");
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0 << " [--policy a,b,...] [--sets N] [--ways N] [--warmup N] [--list] <trace.bin>..." << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> policy_names;
+  uint32_t num_set = 2048;
+  uint32_t num_way = 16;
+  uint64_t warmup_records = 0;
+  std::vector<std::string> paths;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument(arg + " needs a value");
+        return argv[++i];
+      };
+
+      if (arg == "--list") {
+        for (const auto& entry : replacement::runtime::registry)
+          std::cout << entry.name << "\n";
+        return 0;
+      } else if (arg == "--policy") {
+        std::istringstream list{value()};
+        std::string name;
+        while (std::getline(list, name, ','))
+          if (!name.empty())
+            policy_names.push_back(name);
+      } else if (arg == "--sets") {
+        num_set = static_cast<uint32_t>(std::stoul(value()));
+      } else if (arg == "--ways") {
+        num_way = static_cast<uint32_t>(std::stoul(value()));
+      } else if (arg == "--warmup") {
+        warmup_records = std::stoull(value());
+      } else if (arg.rfind("--", 0) == 0) {
+        throw std::invalid_argument("unknown option " + arg);
+      } else {
+        paths.push_back(arg);
+      }
+    }
+    if (paths.empty())
+      throw std::invalid_argument("no trace given");
+    if (num_set == 0 || (num_set & (num_set - 1)) != 0 || num_way == 0)
+      throw std::invalid_argument("the number of sets must be a power of two and the number of ways nonzero");
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  // belady reads its future from the trace being replayed, unless told otherwise
+  std::string trace_list;
+  for (const auto& path : paths)
+    trace_list += (trace_list.empty() ? "" : ",") + path;
+  ::setenv("BELADY_TRACE", trace_list.c_str(), 0);
+
+  if (policy_names.empty()) {
+    for (const auto& entry : replacement::runtime::registry)
+      if (std::string name = entry.name; name != "lruStat" && (name != "mlPredict" || std::getenv("MLPREDICT_MODEL") != nullptr))
+        policy_names.push_back(name);
+  }
+
+  try {
+    CACHE cache{"LLC", num_set, num_way};
+    cache.warmup = warmup_records > 0;
+
+    std::vector<replay> replays;
+    for (const auto& name : policy_names)
+      replays.push_back({{name, make_policy(name, &cache), cache}});
+    for (auto& r : replays)
+      r.tags.initialize();
+
+    lrustat::merged_stream stream{paths};
+    std::vector<lrustat::access_record> records;
+    uint64_t replayed = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // Each policy replays a whole block in turn, which keeps its state hot in the host cache
+    while (stream.next(records)) {
+      for (const auto& record : records) {
+        if (record.cpu >= NUM_CPUS)
+          throw std::runtime_error("trace has CPU " + std::to_string(record.cpu) + "; rebuild with -DLLC_REPLAY_NUM_CPUS=" + std::to_string(record.cpu + 1));
+      }
+
+      for (auto& r : replays) {
+        auto block_start = std::chrono::steady_clock::now();
+        uint64_t index = replayed;
+        for (const auto& record : records) {
+          if (index++ == warmup_records)
+            r.tags.reset_counts();
+          cache.current_cycle = record.cycle;
+          cache.warmup = index <= warmup_records;
+          uint32_t set = static_cast<uint32_t>((record.address >> LOG2_BLOCK_SIZE) & (num_set - 1));
+          r.tags.access(record.cpu, set, record.address, record.ip, record.type);
+        }
+        r.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - block_start).count();
+      }
+      replayed += records.size();
+    }
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Replayed " << replayed << " records (" << std::min(replayed, warmup_records) << " warmup) on " << num_set << " sets x " << num_way
+              << " ways in " << std::fixed << std::setprecision(3) << total_seconds << " s\n\n";
+    for (auto& r : replays) {
+      r.tags.final_stats();
+      r.tags.counts().print(std::cout, cache.NAME + " " + r.tags.policy_name());
+    }
+
+    std::cout << "\n" << std::left << std::setw(16) << "policy" << std::right << std::setw(12) << "accesses" << std::setw(12) << "hits" << std::setw(10)
+              << "hit rate" << std::setw(12) << "Maccess/s" << "\n";
+    for (const auto& r : replays) {
+      uint64_t hits = 0, accesses = 0;
+      for (std::size_t type = 0; type < replacement::runtime::access_counts::NUM_TYPES; ++type) {
+        hits += r.tags.counts().hits[type];
+        accesses += r.tags.counts().hits[type] + r.tags.counts().misses[type];
+      }
+      std::cout << std::left << std::setw(16) << r.tags.policy_name() << std::right << std::setw(12) << accesses << std::setw(12) << hits << std::setw(10)
+                << std::setprecision(4) << (accesses > 0 ? static_cast<double>(hits) / accesses : 0.0) << std::setw(12) << std::setprecision(2)
+                << (r.seconds > 0 ? replayed / r.seconds / 1e6 : 0.0) << "\n";
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
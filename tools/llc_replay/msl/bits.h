@@ -0,0 +1,12 @@
+// The part of ChampSim's inc/msl/bits.h that the replacement policies use.
+#ifndef MSL_BITS_H
+#define MSL_BITS_H
+
+#include <cstdint>
+
+namespace champsim
+{
+constexpr unsigned lg2(uint64_t n) { return n < 2 ? 0 : 1 + lg2(n >> 1); }
+} // namespace champsim
+
+#endif
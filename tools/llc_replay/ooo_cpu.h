@@ -0,0 +1,7 @@
+// Stand-in for ChampSim's inc/ooo_cpu.h; the policies only need what cache.h provides.
+#ifndef OOO_CPU_H
+#define OOO_CPU_H
+
+#include "cache.h"
+
+#endif
@@ -0,0 +1,215 @@
+// Convert an lruStat trace, or one of the CSVs lruStat used to write, into the
+// columnar layout of replacement/lruStat/access_columns.h.
+//
+// Build from the repository root, with the same codec flags the trace was
+// written with:
+//   g++ -O2 -std=c++17 -I replacement/lruStat tools/lrustat2col.cc -o lrustat2col
+//   (add -DLRUSTAT_ZSTD ... -lzstd or -DLRUSTAT_XZ ... -llzma for compressed traces)
+//
+// Usage: lrustat2col <trace.bin | accesses.csv> <out.col>
+//
+// A CSV needs the Memory Address, Cache Set, Access Type, Cycle Count and
+// Hit/Miss columns; IP and CPU are read if present (lrustat2csv --all) and are
+// zero otherwise. READ is stored as a LOAD.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "access_columns.h"
+#include "trace_reader.h"
+
+namespace
+{
+constexpr std::size_t BLOCK_RECORDS = std::size_t{1} << 16;
+
+uint8_t parse_type(const std::string& name)
+{
+  if (name == "READ")
+    return 0;
+  for (std::size_t i = 0; i < std::size(lrustat::ACCESS_TYPE_NAMES); ++i)
+    if (name == lrustat::ACCESS_TYPE_NAMES[i])
+      return static_cast<uint8_t>(i);
+  throw std::runtime_error("unknown access type " + name);
+}
+
+// Reads the CSV a block of records at a time, like trace_reader
+class csv_reader
+{
+public:
+  explicit csv_reader(const std::string& path) : path_(path)
+  {
+    in_ = std::fopen(path_.c_str(), "r");
+    if (in_ == nullptr)
+      throw std::runtime_error("cannot open " + path_);
+
+    std::string line;
+    if (!read_line(line)) {
+      std::fclose(in_);
+      throw std::runtime_error(path_ + " is empty");
+    }
+    std::istringstream header{line};
+    std::string name;
+    for (int index = 0; std::getline(header, name, ','); ++index) {
+      for (std::size_t field = 0; field < std::size(FIELD_NAMES); ++field)
+        if (name == FIELD_NAMES[field])
+          fields_[field] = index;
+    }
+    for (std::size_t field = 0; field < REQUIRED_FIELDS; ++field) {
+      if (fields_[field] < 0) {
+        std::fclose(in_);
+        throw std::runtime_error(path_ + " has no " + FIELD_NAMES[field] + " column");
+      }
+    }
+  }
+
+  csv_reader(const csv_reader&) = delete;
+  csv_reader& operator=(const csv_reader&) = delete;
+  ~csv_reader() { std::fclose(in_); }
+
+  bool next(std::vector<lrustat::access_record>& records)
+  {
+    records.clear();
+    std::string line;
+    std::vector<std::string> values;
+    while (records.size() < BLOCK_RECORDS && read_line(line)) {
+      if (line.empty())
+        continue;
+      values.clear();
+      std::istringstream row{line};
+      for (std::string value; std::getline(row, value, ',');)
+        values.push_back(value);
+
+      auto field = [&](std::size_t f) -> const std::string& {
+        static const std::string zero{"0"};
+        if (fields_[f] < 0)
+          return zero;
+        if (static_cast<std::size_t>(fields_[f]) >= values.size())
+          throw std::runtime_error(path_ + " has a short line: " + line);
+        return values[fields_[f]];
+      };
+
+      lrustat::access_record r{};
+      r.address = std::stoull(field(ADDRESS));
+      r.set = static_cast<uint32_t>(std::stoul(field(SET)));
+      r.type = parse_type(field(TYPE));
+      r.cycle = std::stoull(field(CYCLE));
+      r.hit = static_cast<uint8_t>(std::stoul(field(HIT)));
+      r.ip = std::stoull(field(IP));
+      r.cpu = static_cast<uint16_t>(std::stoul(field(CPU)));
+      records.push_back(r);
+    }
+    return !records.empty();
+  }
+
+private:
+  enum : std::size_t { ADDRESS, SET, TYPE, CYCLE, HIT, REQUIRED_FIELDS, IP = REQUIRED_FIELDS, CPU, NUM_FIELDS };
+  static constexpr const char* FIELD_NAMES[NUM_FIELDS] = {"Memory Address", "Cache Set", "Access Type", "Cycle Count", "Hit/Miss", "IP", "CPU"};
+
+  bool read_line(std::string& line)
+  {
+    line.clear();
+    char buffer[256];
+    while (std::fgets(buffer, sizeof(buffer), in_) != nullptr) {
+      line += buffer;
+      if (!line.empty() && line.back() == '\n') {
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+          line.pop_back();
+        return true;
+      }
+    }
+    return !line.empty();
+  }
+
+  std::string path_;
+  std::FILE* in_ = nullptr;
+  int fields_[NUM_FIELDS] = {-1, -1, -1, -1, -1, -1, -1};
+};
+
+// Call f on every block of records in the input
+template <typename F>
+void for_each_block(const std::string& path, F&& f)
+{
+  std::vector<lrustat::access_record> records;
+  if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0) {
+    csv_reader in{path};
+    while (in.next(records))
+      f(records);
+  } else {
+    lrustat::trace_reader in{path};
+    while (in.next(records))
+      f(records);
+  }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " <trace.bin | accesses.csv> <out.col>" << std::endl;
+    return 1;
+  }
+  std::string in_path = argv[1];
+  std::string out_path = argv[2];
+
+  try {
+    // One pass to size the file, one to fill it
+    uint64_t count = 0;
+    for_each_block(in_path, [&](const auto& records) { count += records.size(); });
+
+    lrustat::column_layout layout{count};
+    int fd = ::open(out_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(layout.size)) != 0)
+      throw std::runtime_error("cannot create " + out_path);
+    void* base = ::mmap(nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+      throw std::runtime_error("cannot map " + out_path);
+
+    auto* bytes = static_cast<char*>(base);
+    std::memcpy(bytes, &layout.header, sizeof(layout.header));
+    std::memcpy(bytes + sizeof(layout.header), layout.entries.data(), sizeof(layout.entries));
+    auto column = [&](lrustat::column c) { return bytes + layout.entries[static_cast<std::size_t>(c)].offset; };
+    auto* address = reinterpret_cast<uint64_t*>(column(lrustat::column::address));
+    auto* ip = reinterpret_cast<uint64_t*>(column(lrustat::column::ip));
+    auto* cycle = reinterpret_cast<uint64_t*>(column(lrustat::column::cycle));
+    auto* set = reinterpret_cast<uint32_t*>(column(lrustat::column::set));
+    auto* cpu = reinterpret_cast<uint16_t*>(column(lrustat::column::cpu));
+    auto* type = reinterpret_cast<uint8_t*>(column(lrustat::column::type));
+    auto* hit = reinterpret_cast<uint8_t*>(column(lrustat::column::hit));
+
+    uint64_t i = 0;
+    for_each_block(in_path, [&](const auto& records) {
+      if (i + records.size() > count)
+        throw std::runtime_error(in_path + " changed while it was converted");
+      for (const auto& r : records) {
+        address[i] = r.address;
+        ip[i] = r.ip;
+        cycle[i] = r.cycle;
+        set[i] = r.set;
+        cpu[i] = r.cpu;
+        type[i] = r.type;
+        hit[i] = r.hit;
+        ++i;
+      }
+    });
+
+    if (::msync(base, layout.size, MS_SYNC) != 0 || ::munmap(base, layout.size) != 0)
+      throw std::runtime_error("cannot write " + out_path);
+    std::cout << out_path << ": " << count << " accesses, " << layout.size << " bytes" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
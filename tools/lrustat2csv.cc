@@ -0,0 +1,80 @@
+// Convert an lruStat binary access trace back into the CSV the notebooks read.
+//
+// Build from the repository root, with the same codec flags the trace was
+// written with:
+//   g++ -O2 -std=c++17 -I replacement/lruStat tools/lrustat2csv.cc -o lrustat2csv
+//   (add -DLRUSTAT_ZSTD ... -lzstd or -DLRUSTAT_XZ ... -llzma for compressed traces)
+//
+// Usage: lrustat2csv [--all] <trace.bin> [out.csv]
+//
+// The default columns match the old lruStat CSV output: Access Type is READ or
+// WRITE and Data Size is the 64-byte block. --all adds the IP and CPU columns
+// and prints the full access type name instead.
+
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "trace_reader.h"
+
+namespace
+{
+bool print_all = false;
+
+void print_records(std::FILE* out, const lrustat::access_record* records, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto& r = records[i];
+    const char* type;
+    if (print_all)
+      type = r.type < std::size(lrustat::ACCESS_TYPE_NAMES) ? lrustat::ACCESS_TYPE_NAMES[r.type] : "UNKNOWN";
+    else
+      type = r.type == lrustat::ACCESS_TYPE_WRITE ? "WRITE" : "READ";
+
+    std::fprintf(out, "%llu,%u,%s,%llu,64,%u", static_cast<unsigned long long>(r.address), r.set, type,
+                 static_cast<unsigned long long>(r.cycle), static_cast<unsigned>(r.hit));
+    if (print_all)
+      std::fprintf(out, ",%llu,%u", static_cast<unsigned long long>(r.ip), static_cast<unsigned>(r.cpu));
+    std::fputc('\n', out);
+  }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  if (!args.empty() && args.front() == "--all") {
+    print_all = true;
+    args.erase(args.begin());
+  }
+  if (args.empty() || args.size() > 2) {
+    std::cerr << "usage: " << argv[0] << " [--all] <trace.bin> [out.csv]" << std::endl;
+    return 1;
+  }
+
+  std::FILE* out = args.size() > 1 ? std::fopen(args[1].c_str(), "w") : stdout;
+  if (out == nullptr) {
+    std::cerr << "cannot open " << args[1] << std::endl;
+    return 1;
+  }
+
+  try {
+    lrustat::trace_reader in{args[0]};
+
+    std::fputs("Memory Address,Cache Set,Access Type,Cycle Count,Data Size,Hit/Miss", out);
+    std::fputs(print_all ? ",IP,CPU\n" : "\n", out);
+
+    std::vector<lrustat::access_record> records;
+    while (in.next(records))
+      print_records(out, records.data(), records.size());
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  if (out != stdout)
+    std::fclose(out);
+  return 0;
+}
@@ -0,0 +1,305 @@
+// Miss-ratio curves of an LLC access stream under LRU, for every capacity and
+// associativity, in one pass.
+//
+// Build from the repository root (add the lruStat codec flags to read
+// compressed traces):
+//   g++ -O2 -std=c++17 -I replacement/lruStat tools/mrc_profile.cc -o mrc_profile
+//
+// Usage: mrc_profile [options] <trace.bin | trace.col>...
+//   --sets a,b,...  set counts to profile; 1 is fully associative
+//                   (default 1,1024,2048,4096)
+//   --ways N        largest associativity reported for set counts above 1
+//                   (default 32)
+//   --sample R      SHARDS: profile only the blocks whose hash falls in a
+//                   fraction R of the hash space, and scale the distances by
+//                   1/R (default 1, exact)
+//   --warmup N      let the first N accesses fill the stacks without counting them
+//   -o FILE         write the curves there instead of to stdout
+//
+// The input is the same stream lruStat captures and llc_replay replays (per-CPU
+// traces are merged by cycle). Every access is looked up in an LRU stack per
+// set; the depth it is found at is its stack distance, and it hits in any
+// cache with that many sets and more ways than the distance. A histogram of
+// distances therefore gives the miss ratio of every associativity at once.
+//
+// Stack distances come from a Fenwick tree over each set's own timestamps,
+// holding a mark at the latest access of every block in the set: the
+// distance of an access is the number of marks after the block's previous
+// access, and costs O(log n). Timestamps are renumbered when a tree fills up,
+// so its size follows the number of distinct blocks rather than the length of
+// the trace.
+//
+// Output is CSV: sets, ways, capacity in blocks and KiB, and miss ratio. Set
+// count 1 is reported at four capacities per octave up to the footprint of
+// the stream; other set counts at every associativity up to --ways.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "access_stream.h"
+
+namespace
+{
+constexpr unsigned LOG2_BLOCK_SIZE = 6;
+constexpr uint64_t COLD = std::numeric_limits<uint64_t>::max();
+
+// The LRU stack of one set, as a Fenwick tree over the set's timestamps
+class lru_stack
+{
+public:
+  // Stack distance of an access to block id, or COLD for its first access.
+  // last holds each block's latest timestamp in this set (0 for none).
+  uint64_t access(uint32_t id, std::vector<uint32_t>& last)
+  {
+    uint64_t distance = COLD;
+    if (uint32_t previous = last[id]; previous != 0) {
+      distance = prefix(now) - prefix(previous);
+      add(previous, -1);
+      owner[previous] = 0;
+      --live;
+    }
+
+    if (now + 1 >= owner.size())
+      compact(last);
+    ++now;
+    add(now, 1);
+    owner[now] = id + 1;
+    last[id] = now;
+    ++live;
+    return distance;
+  }
+
+private:
+  std::vector<uint32_t> tree{0};  // 1-based
+  std::vector<uint32_t> owner{0}; // block id + 1 whose latest access is at each timestamp, or 0
+  uint32_t now = 0;
+  uint32_t live = 0;
+
+  uint32_t prefix(uint32_t ts) const
+  {
+    uint32_t sum = 0;
+    for (; ts > 0; ts &= ts - 1)
+      sum += tree[ts];
+    return sum;
+  }
+
+  void add(uint32_t ts, int32_t delta)
+  {
+    for (; ts < tree.size(); ts += ts & (0 - ts))
+      tree[ts] += delta;
+  }
+
+  // Renumber the live timestamps 1..live, with room for as many accesses again
+  void compact(std::vector<uint32_t>& last)
+  {
+    std::vector<uint32_t> moved(2 * static_cast<std::size_t>(live) + 64);
+    uint32_t ts = 0;
+    for (uint32_t old = 1; old <= now; ++old) {
+      if (owner[old] != 0) {
+        moved[++ts] = owner[old];
+        last[owner[old] - 1] = ts;
+      }
+    }
+    owner = std::move(moved);
+    now = ts;
+
+    // Linear-time build with a mark at every live timestamp
+    tree.assign(owner.size(), 0);
+    for (uint32_t i = 1; i < tree.size(); ++i) {
+      tree[i] += owner[i] != 0;
+      if (uint32_t parent = i + (i & (0 - i)); parent < tree.size())
+        tree[parent] += tree[i];
+    }
+  }
+};
+
+// Every set of a cache with num_set sets, and the distance histogram over them
+struct set_profile {
+  uint32_t num_set;
+  std::vector<lru_stack> stacks;
+  std::vector<uint32_t> last; // per block id
+  std::vector<uint64_t> histogram;
+  uint64_t cold = 0;
+
+  explicit set_profile(uint32_t num_set) : num_set(num_set), stacks(num_set) {}
+
+  void access(uint64_t block, uint32_t id, double scale, bool counted)
+  {
+    if (id >= last.size())
+      last.resize(std::max<std::size_t>(id + 1, 2 * last.size()));
+
+    uint64_t distance = stacks[block & (num_set - 1)].access(id, last);
+    if (!counted)
+      return;
+    if (distance == COLD) {
+      ++cold;
+      return;
+    }
+    auto scaled = static_cast<std::size_t>(distance * scale);
+    if (scaled >= histogram.size())
+      histogram.resize(scaled + 1);
+    ++histogram[scaled];
+  }
+
+  uint64_t accesses() const
+  {
+    uint64_t total = cold;
+    for (uint64_t count : histogram)
+      total += count;
+    return total;
+  }
+};
+
+// SHARDS sampling decision for a block: a fixed fraction of the hash space
+bool sampled(uint64_t block, uint64_t threshold)
+{
+  uint64_t x = block + 0x9E3779B97F4A7C15ULL; // splitmix64
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return (x >> 40) < threshold;
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0 << " [--sets a,b,...] [--ways N] [--sample R] [--warmup N] [-o FILE] <trace.bin | trace.col>..." << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::vector<uint32_t> set_counts;
+  uint32_t max_ways = 32;
+  double rate = 1.0;
+  uint64_t warmup = 0;
+  std::string out_path;
+  std::vector<std::string> paths;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument(arg + " needs a value");
+        return argv[++i];
+      };
+
+      if (arg == "--sets") {
+        std::istringstream list{value()};
+        for (std::string count; std::getline(list, count, ',');)
+          set_counts.push_back(static_cast<uint32_t>(std::stoul(count)));
+      } else if (arg == "--ways") {
+        max_ways = static_cast<uint32_t>(std::stoul(value()));
+      } else if (arg == "--sample") {
+        rate = std::stod(value());
+      } else if (arg == "--warmup") {
+        warmup = std::stoull(value());
+      } else if (arg == "-o") {
+        out_path = value();
+      } else if (!arg.empty() && arg[0] == '-') {
+        throw std::invalid_argument("unknown option " + arg);
+      } else {
+        paths.push_back(arg);
+      }
+    }
+    if (paths.empty())
+      throw std::invalid_argument("no trace given");
+    if (!(rate > 0 && rate <= 1))
+      throw std::invalid_argument("the sampling rate must be in (0, 1]");
+    if (set_counts.empty())
+      set_counts = {1, 1024, 2048, 4096};
+    for (uint32_t count : set_counts)
+      if (count == 0 || (count & (count - 1)) != 0)
+        throw std::invalid_argument("set counts must be powers of two");
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<set_profile> profiles(set_counts.begin(), set_counts.end());
+  std::unordered_map<uint64_t, uint32_t> ids;
+  const auto threshold = static_cast<uint64_t>(std::ldexp(rate, 24));
+  const double scale = 1.0 / rate;
+  uint64_t accesses = 0;
+  uint64_t profiled = 0;
+
+  try {
+    lrustat::merged_stream stream{paths};
+    std::vector<lrustat::access_record> records;
+    while (stream.next(records)) {
+      for (const auto& r : records) {
+        bool counted = accesses++ >= warmup;
+        uint64_t block = r.address >> LOG2_BLOCK_SIZE;
+        if (rate < 1 && !sampled(block, threshold))
+          continue;
+
+        auto [it, inserted] = ids.try_emplace(block, static_cast<uint32_t>(ids.size()));
+        for (auto& profile : profiles)
+          profile.access(block, it->second, scale, counted);
+        profiled += counted;
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  std::ofstream file;
+  if (!out_path.empty()) {
+    file.open(out_path);
+    if (!file) {
+      std::cerr << "cannot open " << out_path << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = out_path.empty() ? std::cout : file;
+
+  auto footprint = static_cast<uint64_t>(ids.size() * scale);
+  std::cerr << accesses << " accesses, " << profiled << " profiled" << (rate < 1 ? " (sampled)" : "") << ", footprint about " << footprint << " blocks"
+            << std::endl;
+
+  out << "sets,ways,capacity_blocks,capacity_kib,miss_ratio\n";
+  for (const auto& profile : profiles) {
+    uint64_t total = profile.accesses();
+    if (total == 0)
+      continue;
+
+    // Capacities to report, in ways: every one up to --ways, or four per octave for fully associative
+    std::vector<uint64_t> ways;
+    if (profile.num_set > 1) {
+      for (uint64_t w = 1; w <= max_ways; ++w)
+        ways.push_back(w);
+    } else {
+      for (uint64_t octave = 1; octave <= std::max<uint64_t>(footprint, 1); octave *= 2)
+        for (uint64_t quarter : {4, 5, 6, 7})
+          if (uint64_t w = octave * quarter / 4; w <= footprint && (ways.empty() || w > ways.back()))
+            ways.push_back(w);
+      if (ways.empty() || ways.back() < footprint)
+        ways.push_back(footprint);
+    }
+
+    // Hits in w ways are the accesses with distance below w
+    uint64_t hits = 0;
+    std::size_t distance = 0;
+    for (uint64_t w : ways) {
+      for (; distance < w && distance < profile.histogram.size(); ++distance)
+        hits += profile.histogram[distance];
+      uint64_t blocks = w * profile.num_set;
+      out << profile.num_set << "," << w << "," << blocks << "," << (blocks << LOG2_BLOCK_SIZE) / 1024 << "," << static_cast<double>(total - hits) / total
+          << "\n";
+    }
+  }
+  return 0;
+}
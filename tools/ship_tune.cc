@@ -0,0 +1,394 @@
+// Search the settings of a SHiP-family policy for the best LLC hit rate at
+// each predictor size, replaying captured traces in parallel.
+//
+// Build from the repository root, like llc_replay (add the lruStat codec
+// flags to read compressed traces, and -DLLC_REPLAY_NUM_CPUS=N for traces
+// from N cores):
+//   g++ -O2 -std=c++17 -I tools/llc_replay -I replacement/lruStat -I replacement/runtime
+//       tools/ship_tune.cc replacement/runtime/*.cc -lpthread -o ship_tune
+//
+// Usage: ship_tune [options] <workload>...
+//   --policy NAME     policy to tune (default shipPP)
+//   --param S=a,b,... values to try for setting S, e.g. SHIP_SHCT_MAX=1,3,7;
+//                     repeat for each setting to vary (see ship::params for
+//                     the SHiP ones). Every combination is a candidate.
+//   --sets N          LLC sets (default 2048)
+//   --ways N          LLC ways (default 16)
+//   --warmup N        replay the first N records of each workload as warmup
+//   --eta N           keep about 1/N of the candidates after each round (default 3)
+//   -j N              replays run in parallel (default: number of cores)
+//   -o FILE           also write every candidate's last result there as CSV
+//
+// A workload is one trace (lruStat or lrustat2col format), or the per-CPU
+// traces of one run joined with commas. Each is read into memory once.
+//
+// The search is successive halving. The first round replays every candidate
+// on a short prefix of every workload; each later round keeps the best 1/eta
+// of the candidates by mean hit rate, plus every candidate on the Pareto
+// front of hit rate against storage bits, and replays them on eta times as
+// much, until the last round replays the survivors on whole workloads. A
+// candidate is the policy with its settings given per cache
+// (<setting>_<cache name>, see policy::setting), so all of them run side by
+// side in one process. Storage is the policy's own count of the bits it adds
+// to the cache (policy::storage_bits).
+//
+// Candidates whose settings the policy rejects are reported and skipped before
+// the first round. Output is the survivors of the last round with their
+// storage and mean hit rate over the workloads, smallest first, with the
+// Pareto front marked.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cache.h"
+#include "policies.h"
+#include "access_stream.h"
+#include "shadow.h"
+
+namespace
+{
+struct knob {
+  std::string setting;
+  std::vector<std::string> values;
+};
+
+struct candidate {
+  std::vector<std::string> values; // one per knob
+  uint64_t storage_bits = 0;
+  double hit_rate = 0; // mean over the workloads, in the last round it ran
+  double fraction = 0; // of each workload replayed in that round
+  unsigned round = 0;
+  bool pareto = false;
+};
+
+// The cache a candidate runs as, which its settings are given for
+std::string cache_name(std::size_t candidate) { return "TUNE" + std::to_string(candidate); }
+
+struct workload {
+  std::string name;
+  std::vector<lrustat::access_record> records;
+};
+
+std::vector<std::string> split(const std::string& list, char separator)
+{
+  std::vector<std::string> items;
+  std::istringstream in{list};
+  for (std::string item; std::getline(in, item, separator);)
+    if (!item.empty())
+      items.push_back(item);
+  return items;
+}
+
+workload read_workload(const std::string& spec)
+{
+  workload w{spec, {}};
+  lrustat::merged_stream stream{split(spec, ',')};
+  std::vector<lrustat::access_record> block;
+  while (stream.next(block)) {
+    for (const auto& record : block) {
+      if (record.cpu >= NUM_CPUS)
+        throw std::runtime_error(spec + " has CPU " + std::to_string(record.cpu) + "; rebuild with -DLLC_REPLAY_NUM_CPUS=" + std::to_string(record.cpu + 1));
+    }
+    w.records.insert(w.records.end(), block.begin(), block.end());
+  }
+  return w;
+}
+
+std::unique_ptr<replacement::policy> make_policy(const std::string& name, CACHE* cache)
+{
+  for (const auto& entry : replacement::runtime::registry) {
+    if (name == entry.name)
+      return entry.make(cache);
+  }
+  throw std::invalid_argument("unknown replacement policy " + name);
+}
+
+// Every combination of the knobs' values
+std::vector<candidate> combinations(const std::vector<knob>& knobs)
+{
+  std::vector<candidate> all{candidate{}};
+  for (const auto& k : knobs) {
+    std::vector<candidate> extended;
+    for (const auto& c : all) {
+      for (const auto& value : k.values) {
+        extended.push_back(c);
+        extended.back().values.push_back(value);
+      }
+    }
+    all = std::move(extended);
+  }
+  return all;
+}
+
+// The settings of a candidate, as S=a,T=b
+std::string describe(const std::vector<knob>& knobs, const candidate& c)
+{
+  std::string text;
+  for (std::size_t k = 0; k < knobs.size(); ++k)
+    text += (k > 0 ? "," : "") + knobs[k].setting + "=" + c.values[k];
+  return text.empty() ? "the defaults" : text;
+}
+
+// Mark the candidates no other one beats on both storage and hit rate
+void mark_pareto(std::vector<candidate>& candidates, const std::vector<std::size_t>& among)
+{
+  std::vector<std::size_t> order = among;
+  std::sort(order.begin(), order.end(), [&](auto x, auto y) {
+    const auto &a = candidates[x], &b = candidates[y];
+    return a.storage_bits != b.storage_bits ? a.storage_bits < b.storage_bits : a.hit_rate > b.hit_rate;
+  });
+  double best = -1;
+  for (auto i : order) {
+    candidates[i].pareto = candidates[i].hit_rate > best;
+    best = std::max(best, candidates[i].hit_rate);
+  }
+}
+
+void usage(const char* argv0)
+{
+  std::cerr << "usage: " << argv0 << " [--policy NAME] [--param SETTING=a,b,...]... [--sets N] [--ways N] [--warmup N] [--eta N] [-j N] [-o FILE] <workload>..."
+            << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string policy_name = "shipPP";
+  std::vector<knob> knobs;
+  uint32_t num_set = 2048;
+  uint32_t num_way = 16;
+  uint64_t warmup_records = 0;
+  unsigned eta = 3;
+  unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::string csv_path;
+  std::vector<std::string> workload_specs;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument(arg + " needs a value");
+        return argv[++i];
+      };
+
+      if (arg == "--policy") {
+        policy_name = value();
+      } else if (arg == "--param") {
+        std::string spec = value();
+        auto eq = spec.find('=');
+        if (eq == std::string::npos || eq == 0 || split(spec.substr(eq + 1), ',').empty())
+          throw std::invalid_argument("--param takes SETTING=a,b,..., not " + spec);
+        knobs.push_back({spec.substr(0, eq), split(spec.substr(eq + 1), ',')});
+      } else if (arg == "--sets") {
+        num_set = static_cast<uint32_t>(std::stoul(value()));
+      } else if (arg == "--ways") {
+        num_way = static_cast<uint32_t>(std::stoul(value()));
+      } else if (arg == "--warmup") {
+        warmup_records = std::stoull(value());
+      } else if (arg == "--eta") {
+        eta = static_cast<unsigned>(std::stoul(value()));
+      } else if (arg == "-j") {
+        jobs = std::max(1u, static_cast<unsigned>(std::stoul(value())));
+      } else if (arg == "-o") {
+        csv_path = value();
+      } else if (arg.rfind("-", 0) == 0) {
+        throw std::invalid_argument("unknown option " + arg);
+      } else {
+        workload_specs.push_back(arg);
+      }
+    }
+    if (workload_specs.empty())
+      throw std::invalid_argument("no workload given");
+    if (num_set == 0 || (num_set & (num_set - 1)) != 0 || num_way == 0)
+      throw std::invalid_argument("the number of sets must be a power of two and the number of ways nonzero");
+    if (eta < 2)
+      throw std::invalid_argument("--eta must be at least 2");
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    std::vector<workload> workloads;
+    for (const auto& spec : workload_specs) {
+      workloads.push_back(read_workload(spec));
+      if (workloads.back().records.size() <= warmup_records)
+        throw std::runtime_error(spec + " has no records after the warmup");
+    }
+
+    // Each candidate reads its settings as <setting>_<its cache name>
+    std::vector<candidate> candidates = combinations(knobs);
+    for (std::size_t c = 0; c < candidates.size(); ++c) {
+      for (std::size_t k = 0; k < knobs.size(); ++k)
+        ::setenv((knobs[k].setting + "_" + cache_name(c)).c_str(), candidates[c].values[k].c_str(), 1);
+    }
+
+    // A combination the policy rejects (say an SHCT prime above the SHCT size)
+    // is dropped here, rather than failing the whole search in round 1
+    std::vector<std::size_t> alive;
+    std::cout.setstate(std::ios::badbit);
+    for (std::size_t c = 0; c < candidates.size(); ++c) {
+      try {
+        CACHE cache{cache_name(c), num_set, num_way};
+        replacement::runtime::shadow_cache tags{policy_name, make_policy(policy_name, &cache), cache};
+        tags.initialize();
+        alive.push_back(c);
+      } catch (const std::invalid_argument& e) {
+        std::cerr << "skipping " << describe(knobs, candidates[c]) << ": " << e.what() << std::endl;
+      }
+    }
+    std::cout.clear();
+    if (alive.empty())
+      throw std::runtime_error("no candidate has valid settings");
+
+    unsigned rounds = 1;
+    for (std::size_t n = alive.size(); n > eta; n = (n + eta - 1) / eta)
+      ++rounds;
+
+    std::cerr << policy_name << ": " << alive.size() << " candidates (" << candidates.size() - alive.size() << " skipped), " << workloads.size()
+              << " workloads, " << rounds << " rounds, " << jobs << " jobs" << std::endl;
+
+    for (unsigned round = 0; round < rounds; ++round) {
+      // The last round replays whole workloads; each earlier one 1/eta of the next
+      double fraction = std::pow(static_cast<double>(eta), static_cast<double>(round) - (rounds - 1));
+      bool last = round + 1 == rounds;
+
+      // One job per candidate and workload; hits and accesses land in their own slots
+      std::size_t num_jobs = alive.size() * workloads.size();
+      std::vector<double> hit_rates(num_jobs);
+      std::vector<uint64_t> bits(num_jobs);
+      std::vector<std::exception_ptr> errors(num_jobs);
+      std::atomic<std::size_t> next{0};
+
+      // The policies report their settings as they initialize; that is noise here
+      std::cout.setstate(std::ios::badbit);
+      std::vector<std::thread> workers;
+      for (unsigned w = 0; w < std::min<std::size_t>(jobs, num_jobs); ++w) {
+        workers.emplace_back([&] {
+          for (std::size_t j; (j = next++) < num_jobs;) {
+            std::size_t c = alive[j / workloads.size()];
+            const workload& load = workloads[j % workloads.size()];
+            try {
+              uint64_t counted = load.records.size() - std::min<uint64_t>(warmup_records, load.records.size());
+              uint64_t length = std::min<uint64_t>(load.records.size(), warmup_records + (last ? counted : static_cast<uint64_t>(std::ceil(counted * fraction))));
+
+              CACHE cache{cache_name(c), num_set, num_way};
+              replacement::runtime::shadow_cache tags{policy_name, make_policy(policy_name, &cache), cache};
+              cache.warmup = warmup_records > 0;
+              tags.initialize();
+              bits[j] = tags.storage_bits();
+
+              for (uint64_t index = 0; index < length; ++index) {
+                const auto& record = load.records[index];
+                if (index == warmup_records)
+                  tags.reset_counts();
+                cache.current_cycle = record.cycle;
+                cache.warmup = index < warmup_records;
+                uint32_t set = static_cast<uint32_t>((record.address >> LOG2_BLOCK_SIZE) & (num_set - 1));
+                tags.access(record.cpu, set, record.address, record.ip, record.type);
+              }
+
+              uint64_t hits = 0, accesses = 0;
+              for (std::size_t type = 0; type < replacement::runtime::access_counts::NUM_TYPES; ++type) {
+                hits += tags.counts().hits[type];
+                accesses += tags.counts().hits[type] + tags.counts().misses[type];
+              }
+              hit_rates[j] = accesses > 0 ? static_cast<double>(hits) / accesses : 0.0;
+            } catch (...) {
+              errors[j] = std::current_exception();
+            }
+          }
+        });
+      }
+      for (auto& worker : workers)
+        worker.join();
+      std::cout.clear();
+
+      for (std::size_t j = 0; j < num_jobs; ++j) {
+        if (!errors[j])
+          continue;
+        try {
+          std::rethrow_exception(errors[j]);
+        } catch (const std::exception& e) {
+          throw std::runtime_error(describe(knobs, candidates[alive[j / workloads.size()]]) + " on " + workloads[j % workloads.size()].name + ": " + e.what());
+        }
+      }
+
+      for (std::size_t a = 0; a < alive.size(); ++a) {
+        candidate& cand = candidates[alive[a]];
+        double sum = 0;
+        for (std::size_t w = 0; w < workloads.size(); ++w)
+          sum += hit_rates[a * workloads.size() + w];
+        cand.hit_rate = sum / workloads.size();
+        cand.storage_bits = bits[a * workloads.size()];
+        cand.round = round + 1;
+        cand.fraction = fraction;
+      }
+      mark_pareto(candidates, alive);
+
+      std::size_t evaluated = alive.size();
+      if (!last) {
+        // Keep the best by hit rate, and the front, which the best alone would thin out
+        std::sort(alive.begin(), alive.end(), [&](auto x, auto y) { return candidates[x].hit_rate > candidates[y].hit_rate; });
+        std::size_t keep = (alive.size() + eta - 1) / eta;
+        alive.erase(std::remove_if(alive.begin() + static_cast<std::ptrdiff_t>(keep), alive.end(), [&](auto c) { return !candidates[c].pareto; }), alive.end());
+      }
+      std::cerr << "round " << (round + 1) << ": " << evaluated << " candidates on " << std::fixed << std::setprecision(1) << 100 * fraction
+                << "% of each workload, " << alive.size() << " kept" << std::endl;
+    }
+
+    // Survivors by storage, smallest first
+    std::sort(alive.begin(), alive.end(), [&](auto x, auto y) {
+      const auto &a = candidates[x], &b = candidates[y];
+      return a.storage_bits != b.storage_bits ? a.storage_bits < b.storage_bits : a.hit_rate > b.hit_rate;
+    });
+
+    std::cout << "\n" << std::fixed;
+    for (const auto& k : knobs)
+      std::cout << std::left << std::setw(std::max<int>(12, static_cast<int>(k.setting.size()) + 2)) << k.setting;
+    std::cout << std::right << std::setw(14) << "bits" << std::setw(10) << "KiB" << std::setw(10) << "hit rate" << "  pareto\n";
+    for (auto c : alive) {
+      const auto& cand = candidates[c];
+      for (std::size_t k = 0; k < knobs.size(); ++k)
+        std::cout << std::left << std::setw(std::max<int>(12, static_cast<int>(knobs[k].setting.size()) + 2)) << cand.values[k];
+      std::cout << std::right << std::setw(14) << cand.storage_bits << std::setw(10) << std::setprecision(1) << cand.storage_bits / 8192.0 << std::setw(10)
+                << std::setprecision(4) << cand.hit_rate << (cand.pareto ? "  *" : "") << "\n";
+    }
+
+    if (!csv_path.empty()) {
+      std::ofstream csv{csv_path};
+      if (!csv)
+        throw std::runtime_error("cannot write " + csv_path);
+      for (const auto& k : knobs)
+        csv << k.setting << ",";
+      csv << "storage_bits,round,workload_fraction,mean_hit_rate,pareto\n";
+      for (const auto& cand : candidates) {
+        if (cand.round == 0)
+          continue; // skipped for invalid settings
+        for (const auto& value : cand.values)
+          csv << value << ",";
+        csv << cand.storage_bits << "," << cand.round << "," << std::setprecision(6) << cand.fraction << "," << cand.hit_rate << ","
+            << (cand.round == rounds && cand.pareto) << "\n";
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,514 @@
+// Summarize a sweep of ChampSim runs: summary.csv plus speedup and MPKI tables.
+//
+// Build from the repository root:
+//   g++ -O2 -std=c++17 tools/sweep_summary.cc -lpthread -o bin/sweep_summary
+//
+// Usage: sweep_summary [-j jobs] [-b baseline] [-o out_dir] <log_dir>...
+//   -j  files read in parallel (default: number of cores)
+//   -b  policy the speedups are relative to (default: lru, or lruStat if no
+//       run used lru)
+//   -o  where to write the tables (default: the first log directory)
+//
+// Every <trace>.<policy>.log in the log directories is one run, named the way
+// the autotest scripts name them. When the run also left <trace>.<policy>.json
+// (ChampSim's --json output, which run_Parallel_Sweep.sh asks for), the stats
+// come from the region of interest of its last phase; otherwise they are
+// scraped from the first "LLC TOTAL" and "cumulative IPC" lines of the log, as
+// log_processor.py does.
+//
+// Output:
+//   summary.csv  one row per run, in the log_processor.py schema
+//   speedup.csv  IPC of each policy over the baseline, per trace, with the
+//                geometric mean over the traces both ran in the last row
+//   mpki.csv     LLC misses per thousand instructions, per trace, with the
+//                arithmetic mean in the last row
+// For multi-core runs IPC is the sum over the cores, and MPKI counts the
+// misses and instructions of every core; summary.csv keeps CPU 0's LLC
+// counts, instructions and cycles, from the .json or the log alike.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+// Just enough JSON for ChampSim's stats output
+struct json {
+  enum class kind { null, boolean, number, string, array, object } type = kind::null;
+  double number = 0;
+  std::string text;
+  std::vector<json> items;
+  std::vector<std::pair<std::string, json>> members;
+
+  const json* find(const std::string& key) const
+  {
+    for (const auto& [name, value] : members)
+      if (name == key)
+        return &value;
+    return nullptr;
+  }
+
+  const json& at(const std::string& key) const
+  {
+    if (const json* value = find(key))
+      return *value;
+    throw std::runtime_error("missing \"" + key + "\"");
+  }
+};
+
+class json_parser
+{
+public:
+  explicit json_parser(const std::string& text) : p(text.data()), end(text.data() + text.size()) {}
+
+  json parse()
+  {
+    json value = parse_value();
+    skip_space();
+    if (p != end)
+      fail("trailing characters");
+    return value;
+  }
+
+private:
+  const char* p;
+  const char* end;
+
+  [[noreturn]] void fail(const char* what) { throw std::runtime_error(std::string{"bad JSON: "} + what); }
+
+  void skip_space()
+  {
+    while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+      ++p;
+  }
+
+  void expect(char c)
+  {
+    skip_space();
+    if (p == end || *p != c)
+      fail("unexpected character");
+    ++p;
+  }
+
+  bool literal(const char* word)
+  {
+    std::size_t n = std::strlen(word);
+    if (static_cast<std::size_t>(end - p) < n || std::strncmp(p, word, n) != 0)
+      return false;
+    p += n;
+    return true;
+  }
+
+  std::string parse_string()
+  {
+    expect('"');
+    std::string out;
+    while (p != end && *p != '"') {
+      if (*p == '\\') {
+        if (++p == end)
+          fail("unterminated string");
+        switch (*p) {
+        case 'n':
+          out += '\n';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u':
+          // Stats keys and values are ASCII; keep other code points as '?'
+          p += std::min<std::ptrdiff_t>(4, end - p - 1);
+          out += '?';
+          break;
+        default:
+          out += *p;
+        }
+        ++p;
+      } else {
+        out += *p++;
+      }
+    }
+    if (p == end)
+      fail("unterminated string");
+    ++p;
+    return out;
+  }
+
+  json parse_value()
+  {
+    skip_space();
+    if (p == end)
+      fail("unexpected end");
+
+    json value;
+    if (*p == '{') {
+      value.type = json::kind::object;
+      ++p;
+      skip_space();
+      if (p != end && *p == '}') {
+        ++p;
+        return value;
+      }
+      do {
+        std::string key = parse_string();
+        expect(':');
+        value.members.emplace_back(std::move(key), parse_value());
+        skip_space();
+      } while (p != end && *p == ',' && ++p);
+      expect('}');
+    } else if (*p == '[') {
+      value.type = json::kind::array;
+      ++p;
+      skip_space();
+      if (p != end && *p == ']') {
+        ++p;
+        return value;
+      }
+      do {
+        value.items.push_back(parse_value());
+        skip_space();
+      } while (p != end && *p == ',' && ++p);
+      expect(']');
+    } else if (*p == '"') {
+      value.type = json::kind::string;
+      value.text = parse_string();
+    } else if (literal("true")) {
+      value.type = json::kind::boolean;
+      value.number = 1;
+    } else if (literal("false")) {
+      value.type = json::kind::boolean;
+    } else if (literal("null")) {
+      value.type = json::kind::null;
+    } else {
+      char* number_end = nullptr;
+      value.type = json::kind::number;
+      value.number = std::strtod(p, &number_end);
+      if (number_end == p)
+        fail("unexpected character");
+      p = number_end;
+    }
+    return value;
+  }
+};
+
+constexpr const char* ACCESS_TYPES[] = {"LOAD", "RFO", "PREFETCH", "WRITE", "TRANSLATION"};
+
+struct run {
+  std::string trace;
+  std::string policy;
+  bool found = false;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t all_misses = 0;   // every CPU's LLC, for MPKI
+  uint64_t instructions = 0; // CPU 0
+  uint64_t cycles = 0;       // CPU 0
+  uint64_t all_instructions = 0;
+  double ipc = 0; // summed over the cores
+  std::string error;
+};
+
+std::string read_file(const fs::path& path)
+{
+  std::ifstream in{path, std::ios::binary};
+  if (!in)
+    throw std::runtime_error("cannot open " + path.string());
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+uint64_t sum_counts(const json& counts)
+{
+  uint64_t total = 0;
+  for (const auto& count : counts.items)
+    total += static_cast<uint64_t>(count.number);
+  return total;
+}
+
+uint64_t first_count(const json& counts) { return counts.items.empty() ? 0 : static_cast<uint64_t>(counts.items.front().number); }
+
+void read_json_stats(const fs::path& path, run& r)
+{
+  json phases = json_parser{read_file(path)}.parse();
+  if (phases.type != json::kind::array || phases.items.empty())
+    throw std::runtime_error(path.string() + " has no phases");
+  const json& roi = phases.items.back().at("roi");
+
+  // The counts are per CPU. summary.csv takes CPU 0's, like the first LLC
+  // TOTAL line of a log; MPKI counts every CPU's misses.
+  const json& llc = roi.at("LLC");
+  for (const char* type : ACCESS_TYPES) {
+    if (const json* counts = llc.find(type)) {
+      r.hits += first_count(counts->at("hit"));
+      r.misses += first_count(counts->at("miss"));
+      r.all_misses += sum_counts(counts->at("miss"));
+    }
+  }
+
+  const auto& cores = roi.at("cores").items;
+  for (std::size_t cpu = 0; cpu < cores.size(); ++cpu) {
+    auto instructions = static_cast<uint64_t>(cores[cpu].at("instructions").number);
+    auto cycles = static_cast<uint64_t>(cores[cpu].at("cycles").number);
+    if (cpu == 0) {
+      r.instructions = instructions;
+      r.cycles = cycles;
+    }
+    r.all_instructions += instructions;
+    r.ipc += cycles > 0 ? static_cast<double>(instructions) / cycles : 0;
+  }
+  r.found = !cores.empty();
+}
+
+// The number after label, searching from pos; npos-safe
+std::optional<uint64_t> number_after(const std::string& text, std::size_t pos, std::size_t limit, const char* label)
+{
+  pos = text.find(label, pos);
+  if (pos == std::string::npos || pos >= limit)
+    return std::nullopt;
+  return std::strtoull(text.c_str() + pos + std::strlen(label), nullptr, 10);
+}
+
+void read_log_stats(const fs::path& path, run& r)
+{
+  std::string log = read_file(path);
+
+  // summary.csv takes the first LLC TOTAL line, as log_processor.py does;
+  // MPKI counts the misses of every CPU's line, like the instructions
+  bool llc_found = false;
+  for (std::size_t llc = log.find("LLC TOTAL"); llc != std::string::npos; llc = log.find("LLC TOTAL", llc + 1)) {
+    std::size_t eol = log.find('\n', llc);
+    auto hits = number_after(log, llc, eol, "HIT:");
+    auto misses = number_after(log, llc, eol, "MISS:");
+    if (!hits || !misses)
+      continue;
+    if (!llc_found) {
+      r.hits = *hits;
+      r.misses = *misses;
+      llc_found = true;
+    }
+    r.all_misses += *misses;
+  }
+
+  for (std::size_t cpu = 0;; ++cpu) {
+    std::size_t line = log.find("CPU " + std::to_string(cpu) + " cumulative IPC:");
+    if (line == std::string::npos)
+      break;
+    std::size_t eol = log.find('\n', line);
+    auto instructions = number_after(log, line, eol, "instructions:");
+    auto cycles = number_after(log, line, eol, "cycles:");
+    if (!instructions || !cycles)
+      break;
+    if (cpu == 0) {
+      r.instructions = *instructions;
+      r.cycles = *cycles;
+      r.found = llc_found;
+    }
+    r.all_instructions += *instructions;
+    r.ipc += *cycles > 0 ? static_cast<double>(*instructions) / *cycles : 0;
+  }
+}
+
+// <trace>.champsimtrace.<policy>.log, or <trace>.<policy>.log
+void name_run(const fs::path& log, run& r)
+{
+  std::string stem = log.stem().string();
+  std::size_t split = stem.find(".champsimtrace");
+  if (split != std::string::npos) {
+    r.trace = stem.substr(0, split);
+    std::size_t policy = stem.find('.', split + 1);
+    r.policy = policy == std::string::npos ? "" : stem.substr(policy + 1);
+  } else {
+    split = stem.rfind('.');
+    r.trace = stem.substr(0, split);
+    r.policy = split == std::string::npos ? "" : stem.substr(split + 1);
+  }
+}
+
+std::string format(double value, int precision)
+{
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(precision) << value;
+  return out.str();
+}
+
+// A trace x policy table with one summary row
+void write_table(const fs::path& path, const std::vector<std::string>& policies, const std::map<std::string, std::map<std::string, double>>& by_trace,
+                 const std::string& summary_name, const std::map<std::string, double>& summary)
+{
+  std::ofstream out{path};
+  out << "trace_name";
+  for (const auto& policy : policies)
+    out << "," << policy;
+  out << "\n";
+  for (const auto& [trace, values] : by_trace) {
+    out << trace;
+    for (const auto& policy : policies) {
+      auto value = values.find(policy);
+      out << "," << (value == values.end() ? "" : format(value->second, 4));
+    }
+    out << "\n";
+  }
+  out << summary_name;
+  for (const auto& policy : policies) {
+    auto value = summary.find(policy);
+    out << "," << (value == summary.end() ? "" : format(value->second, 4));
+  }
+  out << "\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::string baseline;
+  fs::path out_dir;
+  std::vector<fs::path> log_dirs;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-j" || arg == "-b" || arg == "-o") && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (arg == "-j")
+        jobs = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+      else if (arg == "-b")
+        baseline = value;
+      else
+        out_dir = value;
+    } else if (!arg.empty() && arg[0] == '-') {
+      log_dirs.clear();
+      break;
+    } else {
+      log_dirs.emplace_back(arg);
+    }
+  }
+  if (log_dirs.empty()) {
+    std::cerr << "usage: " << argv[0] << " [-j jobs] [-b baseline] [-o out_dir] <log_dir>..." << std::endl;
+    return 1;
+  }
+  if (out_dir.empty())
+    out_dir = log_dirs.front();
+
+  std::vector<fs::path> logs;
+  try {
+    for (const auto& dir : log_dirs)
+      for (const auto& entry : fs::directory_iterator{dir})
+        if (entry.is_regular_file() && entry.path().extension() == ".log")
+          logs.push_back(entry.path());
+  } catch (const fs::filesystem_error& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // Read the runs in parallel; each worker takes the next file until none are left
+  std::vector<run> runs(logs.size());
+  std::atomic<std::size_t> next{0};
+  std::vector<std::thread> workers;
+  for (unsigned w = 0; w < std::min<std::size_t>(jobs, logs.size()); ++w) {
+    workers.emplace_back([&] {
+      for (std::size_t i; (i = next++) < logs.size();) {
+        run& r = runs[i];
+        name_run(logs[i], r);
+        fs::path json_path = fs::path{logs[i]}.replace_extension(".json");
+        try {
+          if (fs::exists(json_path))
+            read_json_stats(json_path, r);
+          else
+            read_log_stats(logs[i], r);
+        } catch (const std::exception& e) {
+          run failed;
+          failed.trace = r.trace;
+          failed.policy = r.policy;
+          failed.error = e.what();
+          r = std::move(failed);
+        }
+      }
+    });
+  }
+  for (auto& worker : workers)
+    worker.join();
+
+  std::sort(runs.begin(), runs.end(), [](const run& a, const run& b) { return std::tie(a.trace, a.policy) < std::tie(b.trace, b.policy); });
+
+  std::ofstream summary{out_dir / "summary.csv"};
+  summary << "trace_name,replacement_policy,hits,misses,total_accesses,empty_column,instructions,cycles\n";
+  std::size_t incomplete = 0;
+  for (const auto& r : runs) {
+    summary << r.trace << "," << r.policy << ",";
+    if (r.found)
+      summary << r.hits << "," << r.misses << "," << (r.hits + r.misses) << ",," << r.instructions << "," << r.cycles << "\n";
+    else
+      summary << ",,,,,\n";
+    if (!r.found) {
+      ++incomplete;
+      std::cerr << "no stats for " << r.trace << " with " << r.policy << (r.error.empty() ? "" : ": " + r.error) << std::endl;
+    }
+  }
+
+  std::set<std::string> policy_set;
+  std::map<std::string, std::map<std::string, const run*>> by_trace;
+  for (const auto& r : runs) {
+    if (r.found) {
+      policy_set.insert(r.policy);
+      by_trace[r.trace][r.policy] = &r;
+    }
+  }
+  std::vector<std::string> policies(policy_set.begin(), policy_set.end());
+  if (baseline.empty())
+    baseline = policy_set.count("lru") || !policy_set.count("lruStat") ? "lru" : "lruStat";
+
+  std::map<std::string, std::map<std::string, double>> speedup, mpki;
+  std::map<std::string, double> log_speedup_sum, mpki_sum;
+  std::map<std::string, std::size_t> speedup_count, mpki_count;
+  for (const auto& [trace, trace_runs] : by_trace) {
+    auto base = trace_runs.find(baseline);
+    for (const auto& [policy, r] : trace_runs) {
+      if (r->all_instructions > 0) {
+        mpki[trace][policy] = 1000.0 * r->all_misses / r->all_instructions;
+        mpki_sum[policy] += mpki[trace][policy];
+        ++mpki_count[policy];
+      }
+      if (base != trace_runs.end() && base->second->ipc > 0 && r->ipc > 0) {
+        speedup[trace][policy] = r->ipc / base->second->ipc;
+        log_speedup_sum[policy] += std::log(speedup[trace][policy]);
+        ++speedup_count[policy];
+      }
+    }
+  }
+
+  std::map<std::string, double> geomean_speedup, mean_mpki;
+  for (const auto& [policy, count] : speedup_count)
+    geomean_speedup[policy] = std::exp(log_speedup_sum[policy] / count);
+  for (const auto& [policy, count] : mpki_count)
+    mean_mpki[policy] = mpki_sum[policy] / count;
+
+  write_table(out_dir / "speedup.csv", policies, speedup, "geomean", geomean_speedup);
+  write_table(out_dir / "mpki.csv", policies, mpki, "mean", mean_mpki);
+
+  std::cout << runs.size() << " runs (" << incomplete << " without stats) over " << by_trace.size() << " traces; tables in " << out_dir.string() << "\n\n";
+  std::cout << std::left << std::setw(20) << "policy" << std::right << std::setw(8) << "traces" << std::setw(24) << ("speedup vs " + baseline)
+            << std::setw(12) << "mean MPKI" << "\n";
+  for (const auto& policy : policies) {
+    auto s = geomean_speedup.find(policy);
+    std::cout << std::left << std::setw(20) << policy << std::right << std::setw(8) << mpki_count[policy] << std::setw(24)
+              << (s == geomean_speedup.end() ? "-" : format(s->second, 4)) << std::setw(12) << format(mean_mpki[policy], 3) << "\n";
+  }
+  return 0;
+}